@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+/*
+Notes:
+AirportCode packs an airport code of up to four characters (a 3-letter IATA code or a 4-letter ICAO code) into a single std::uint32_t
+
+The first character is stored in the most significant byte and unused bytes are zero, so comparing packed values orders codes exactly like comparing the strings (e.g., "ABC" < "ABCD" < "ABD")
+Codes with more than four characters or with a '\0' cannot be packed
+
+Packed codes are compared, hashed, and copied as integers, so they avoid the heap allocations and character-by-character comparisons of std::string
+*/
+
+class AirportCode {
+    public:
+        static constexpr size_t maxLength = 4;
+
+        AirportCode(); //Creates the empty code
+        explicit AirportCode(std::string_view code); //Packs code (throws std::invalid_argument if it cannot be packed)
+
+        static bool isValid(std::string_view code); //Returns whether code can be packed
+        static AirportCode fromValue(std::uint32_t value); //Returns the code with the given packed value
+
+        std::uint32_t getValue() const; //Returns the packed value
+        size_t size() const; //Returns the number of characters
+        std::string toString() const; //Unpacks the code
+
+        bool operator==(AirportCode other) const { return value == other.value; }
+        bool operator!=(AirportCode other) const { return value != other.value; }
+        bool operator<(AirportCode other) const { return value < other.value; }
+        bool operator<=(AirportCode other) const { return value <= other.value; }
+        bool operator>(AirportCode other) const { return value > other.value; }
+        bool operator>=(AirportCode other) const { return value >= other.value; }
+
+    private:
+        std::uint32_t value;
+};
+
+inline AirportCode::AirportCode() : value(0) {
+}
+
+inline AirportCode::AirportCode(std::string_view code) : value(0) {
+    if (!isValid(code)) {
+        throw std::invalid_argument("AirportCode: cannot pack \"" + std::string(code) + "\"");
+    }
+    for (size_t i = 0; i < code.size(); ++i) {
+        value |= (std::uint32_t) (unsigned char) code[i] << (8 * (maxLength - 1 - i));
+    }
+}
+
+inline bool AirportCode::isValid(std::string_view code) {
+    return code.size() <= maxLength && code.find('\0') == std::string_view::npos;
+}
+
+inline AirportCode AirportCode::fromValue(std::uint32_t value) {
+    AirportCode code;
+    code.value = value;
+    return code;
+}
+
+inline std::uint32_t AirportCode::getValue() const {
+    return value;
+}
+
+inline size_t AirportCode::size() const {
+    size_t length = 0;
+    while (length < maxLength && ((value >> (8 * (maxLength - 1 - length))) & 0xFF) != 0) {
+        ++length;
+    }
+    return length;
+}
+
+inline std::string AirportCode::toString() const {
+    std::string code;
+    for (size_t i = 0; i < size(); ++i) {
+        code.push_back((char) ((value >> (8 * (maxLength - 1 - i))) & 0xFF));
+    }
+    return code;
+}
+
+//Fibonacci hashing spreads the packed bytes over the whole hash (https://en.wikipedia.org/wiki/Hash_function#Fibonacci_hashing)
+namespace std {
+    template <>
+    struct hash<AirportCode> {
+        size_t operator()(AirportCode code) const {
+            return (size_t) ((std::uint64_t) code.getValue() * 11400714819323198485ULL >> 32);
+        }
+    };
+}
@@ -0,0 +1,346 @@
+#include "ContractionHierarchy.h"
+
+namespace {
+    struct ContractionEdge { //Edge of the remaining graph during preprocessing
+        FlightGraph::VertexId target;
+        double weight;
+        FlightGraph::VertexId middle; //Bypassed vertex (FlightGraph::invalidVertexId for an original route)
+    };
+
+    struct Shortcut {
+        FlightGraph::VertexId origin;
+        FlightGraph::VertexId target;
+        double weight;
+    };
+
+    //Witness searches give up after settling this many vertices (a missed witness only adds an unnecessary shortcut)
+    //Priority estimates only need to rank vertices, so they use a much cheaper search than the contraction itself
+    const size_t estimateSettleLimit = 50;
+    const size_t contractionSettleLimit = 500;
+
+    //Adds the edge origin -> target, or lowers the weight of an existing edge between them
+    void addOrUpdateEdge(std::vector<std::vector<ContractionEdge>>& outEdges, std::vector<std::vector<ContractionEdge>>& inEdges, FlightGraph::VertexId origin, FlightGraph::VertexId target, double weight, FlightGraph::VertexId middle) {
+        for (ContractionEdge& edge : outEdges.at(origin)) {
+            if (edge.target == target) {
+                if (weight < edge.weight) {
+                    edge.weight = weight;
+                    edge.middle = middle;
+                    for (ContractionEdge& reverseEdge : inEdges.at(target)) {
+                        if (reverseEdge.target == origin) {
+                            reverseEdge.weight = weight;
+                            reverseEdge.middle = middle;
+                        }
+                    }
+                }
+                return;
+            }
+        }
+        outEdges.at(origin).push_back(ContractionEdge {target, weight, middle});
+        inEdges.at(target).push_back(ContractionEdge {origin, weight, middle});
+    }
+
+    //Finds the shortcuts needed to contract vertex
+    //For each incoming edge u -> vertex, a Dijkstra from u that avoids vertex looks for witnesses to the outgoing neighbors w
+    //Any tentative distance is the length of a real path, so a shortcut is only needed if no path avoiding vertex is at least as short as u -> vertex -> w
+    //isOutTarget is scratch space with one entry per vertex (all false between calls)
+    void findShortcuts(FlightGraph::VertexId vertex, const std::vector<std::vector<ContractionEdge>>& outEdges, const std::vector<std::vector<ContractionEdge>>& inEdges, SearchContext& context, std::vector<bool>& isOutTarget, size_t settleLimit, std::vector<Shortcut>& shortcuts) {
+        shortcuts.clear();
+        if (outEdges.at(vertex).empty()) {
+            return;
+        }
+        double maxOutWeight = 0.0;
+        for (const ContractionEdge& outEdge : outEdges.at(vertex)) {
+            maxOutWeight = std::max(maxOutWeight, outEdge.weight);
+            isOutTarget.at(outEdge.target) = true;
+        }
+
+        for (const ContractionEdge& inEdge : inEdges.at(vertex)) {
+            FlightGraph::VertexId origin = inEdge.target;
+            double maxDistance = inEdge.weight + maxOutWeight;
+
+            context.reset(outEdges.size());
+            context.setDistance(origin, 0.0, FlightGraph::invalidVertexId);
+            context.heap.push(0.0, origin);
+            size_t unsettledTargetCount = outEdges.at(vertex).size(); //The search also stops once every outgoing neighbor is settled
+            while (!context.heap.empty() && unsettledTargetCount > 0 && context.getSettledCount() < settleLimit) {
+                FlightGraph::VertexId minVertex = context.heap.top().second;
+                double minDistance = context.heap.top().first;
+                context.heap.pop();
+                if (context.isSettled(minVertex)) { //Stale entry
+                    continue;
+                }
+                if (minDistance > maxDistance) {
+                    break;
+                }
+                context.settle(minVertex);
+                if (isOutTarget.at(minVertex)) {
+                    --unsettledTargetCount;
+                }
+                for (const ContractionEdge& edge : outEdges.at(minVertex)) {
+                    if (edge.target != vertex && !context.isSettled(edge.target) && minDistance + edge.weight < context.getDistance(edge.target)) {
+                        context.setDistance(edge.target, minDistance + edge.weight, minVertex);
+                        context.heap.push(minDistance + edge.weight, edge.target);
+                    }
+                }
+            }
+
+            for (const ContractionEdge& outEdge : outEdges.at(vertex)) {
+                double viaDistance = inEdge.weight + outEdge.weight;
+                if (outEdge.target != origin && context.getDistance(outEdge.target) > viaDistance) {
+                    shortcuts.push_back(Shortcut {origin, outEdge.target, viaDistance});
+                }
+            }
+        }
+
+        for (const ContractionEdge& outEdge : outEdges.at(vertex)) {
+            isOutTarget.at(outEdge.target) = false;
+        }
+    }
+
+    //Converts per-vertex edge lists into CSR arrays (each row is sorted by target)
+    void buildSearchGraph(std::vector<std::vector<ContractionEdge>>& edges, std::vector<size_t>& offsets, std::vector<FlightGraph::VertexId>& targets, std::vector<double>& weights, std::vector<FlightGraph::VertexId>& middles) {
+        offsets = std::vector<size_t>(edges.size() + 1, 0);
+        for (size_t vertex = 0; vertex < edges.size(); ++vertex) {
+            std::sort(edges.at(vertex).begin(), edges.at(vertex).end(), [](const ContractionEdge& first, const ContractionEdge& second) {
+                return first.target < second.target;
+            });
+            offsets.at(vertex + 1) = offsets.at(vertex) + edges.at(vertex).size();
+            for (const ContractionEdge& edge : edges.at(vertex)) {
+                targets.push_back(edge.target);
+                weights.push_back(edge.weight);
+                middles.push_back(edge.middle);
+            }
+        }
+    }
+}
+
+ContractionHierarchy::ContractionHierarchy(const FlightGraph& graph) : graph(&graph), shortcutCount(0) {
+    size_t vertexCount = graph.getVertexCount();
+
+    //Remaining graph (contracted vertices are removed from their neighbors' lists)
+    std::vector<std::vector<ContractionEdge>> outEdges(vertexCount);
+    std::vector<std::vector<ContractionEdge>> inEdges(vertexCount);
+    for (VertexId vertex = 0; vertex < vertexCount; ++vertex) {
+        const FlightGraph::NeighborRange& incident = graph.neighbors(vertex);
+        for (size_t i = 0; i < incident.size(); ++i) {
+            outEdges.at(vertex).push_back(ContractionEdge {incident.targets[i], incident.weights[i], FlightGraph::invalidVertexId});
+            inEdges.at(incident.targets[i]).push_back(ContractionEdge {vertex, incident.weights[i], FlightGraph::invalidVertexId});
+        }
+    }
+
+    std::vector<std::vector<ContractionEdge>> upwardOutEdges(vertexCount);
+    std::vector<std::vector<ContractionEdge>> upwardInEdges(vertexCount);
+    std::vector<size_t> contractedNeighborCount(vertexCount, 0);
+    rank = std::vector<size_t>(vertexCount, 0);
+
+    SearchContext witnessContext;
+    std::vector<bool> isOutTarget(vertexCount, false);
+    std::vector<Shortcut> shortcuts;
+    auto getPriority = [&](VertexId vertex) { //Edge difference plus contracted neighbors
+        findShortcuts(vertex, outEdges, inEdges, witnessContext, isOutTarget, estimateSettleLimit, shortcuts);
+        return (double) shortcuts.size() - (double) (outEdges.at(vertex).size() + inEdges.at(vertex).size()) + (double) contractedNeighborCount.at(vertex);
+    };
+
+    DaryHeap<VertexId> queue;
+    for (VertexId vertex = 0; vertex < vertexCount; ++vertex) {
+        queue.push(getPriority(vertex), vertex);
+    }
+
+    //Lazy updates - a popped vertex's priority is recomputed, and it goes back into the queue if it is no longer the minimum
+    size_t nextRank = 0;
+    while (!queue.empty()) {
+        VertexId vertex = queue.top().second;
+        queue.pop();
+        double priority = getPriority(vertex);
+        if (!queue.empty() && priority > queue.top().first) {
+            queue.push(priority, vertex);
+            continue;
+        }
+
+        findShortcuts(vertex, outEdges, inEdges, witnessContext, isOutTarget, contractionSettleLimit, shortcuts);
+        rank.at(vertex) = nextRank++;
+        upwardOutEdges.at(vertex) = outEdges.at(vertex); //Every remaining neighbor is contracted later, so these edges lead upward
+        upwardInEdges.at(vertex) = inEdges.at(vertex);
+        for (const ContractionEdge& edge : outEdges.at(vertex)) {
+            std::vector<ContractionEdge>& neighborEdges = inEdges.at(edge.target);
+            neighborEdges.erase(std::remove_if(neighborEdges.begin(), neighborEdges.end(), [vertex](const ContractionEdge& neighborEdge) { return neighborEdge.target == vertex; }), neighborEdges.end());
+            ++contractedNeighborCount.at(edge.target);
+        }
+        for (const ContractionEdge& edge : inEdges.at(vertex)) {
+            std::vector<ContractionEdge>& neighborEdges = outEdges.at(edge.target);
+            neighborEdges.erase(std::remove_if(neighborEdges.begin(), neighborEdges.end(), [vertex](const ContractionEdge& neighborEdge) { return neighborEdge.target == vertex; }), neighborEdges.end());
+            ++contractedNeighborCount.at(edge.target);
+        }
+        outEdges.at(vertex).clear();
+        inEdges.at(vertex).clear();
+
+        for (const Shortcut& shortcut : shortcuts) {
+            addOrUpdateEdge(outEdges, inEdges, shortcut.origin, shortcut.target, shortcut.weight, vertex);
+            ++shortcutCount;
+        }
+    }
+
+    buildSearchGraph(upwardOutEdges, forwardOffsets, forwardTargets, forwardWeights, forwardMiddles);
+    buildSearchGraph(upwardInEdges, backwardOffsets, backwardTargets, backwardWeights, backwardMiddles);
+}
+
+std::vector<std::string> ContractionHierarchy::findShortestPath(const std::string& originAirportCode, const std::string& destinationAirportCode) const {
+    const std::vector<VertexId>& path = findShortestPath(graph->getVertexId(originAirportCode), graph->getVertexId(destinationAirportCode));
+
+    std::vector<std::string> shortestPath;
+    shortestPath.reserve(path.size());
+    for (VertexId vertex : path) {
+        shortestPath.push_back(graph->getAirportCode(vertex));
+    }
+    return shortestPath;
+}
+
+std::vector<ContractionHierarchy::VertexId> ContractionHierarchy::findShortestPath(VertexId origin, VertexId destination) const {
+    std::vector<VertexId> shortestPath;
+    findShortestPath(origin, destination, SearchContext::getThreadContext(0), SearchContext::getThreadContext(1), shortestPath);
+    return shortestPath;
+}
+
+double ContractionHierarchy::findShortestPath(VertexId origin, VertexId destination, SearchContext& forwardContext, SearchContext& backwardContext, std::vector<VertexId>& shortestPath) const {
+    VertexId meetingVertex = FlightGraph::invalidVertexId;
+    double distance = search(origin, destination, forwardContext, backwardContext, meetingVertex);
+
+    shortestPath.clear();
+    if (meetingVertex == FlightGraph::invalidVertexId) { //Unreachable destination (the path only contains the destination, as in FlightGraph::findShortestPath)
+        shortestPath.push_back(destination);
+        return distance;
+    }
+
+    //Hierarchy path from the origin up to the meeting vertex and down to the destination
+    std::vector<VertexId> hierarchyPath;
+    for (VertexId currentVertex = meetingVertex; currentVertex != FlightGraph::invalidVertexId; currentVertex = forwardContext.getPredecessor(currentVertex)) {
+        hierarchyPath.push_back(currentVertex);
+    }
+    std::reverse(hierarchyPath.begin(), hierarchyPath.end());
+    for (VertexId currentVertex = backwardContext.getPredecessor(meetingVertex); currentVertex != FlightGraph::invalidVertexId; currentVertex = backwardContext.getPredecessor(currentVertex)) {
+        hierarchyPath.push_back(currentVertex);
+    }
+
+    shortestPath.push_back(origin);
+    for (size_t i = 0; i + 1 < hierarchyPath.size(); ++i) {
+        unpackEdge(hierarchyPath.at(i), hierarchyPath.at(i + 1), shortestPath);
+    }
+    return distance;
+}
+
+double ContractionHierarchy::getDistance(VertexId origin, VertexId destination, SearchContext& forwardContext, SearchContext& backwardContext) const {
+    VertexId meetingVertex = FlightGraph::invalidVertexId;
+    return search(origin, destination, forwardContext, backwardContext, meetingVertex);
+}
+
+size_t ContractionHierarchy::getShortcutCount() const {
+    return shortcutCount;
+}
+
+//Each iteration advances the search whose next key is smaller, and a search stops once its next key is at least the best distance found so far
+//Every settled vertex that the other search has reached is a candidate meeting vertex
+double ContractionHierarchy::search(VertexId origin, VertexId destination, SearchContext& forwardContext, SearchContext& backwardContext, VertexId& meetingVertex) const {
+    size_t vertexCount = rank.size();
+    forwardContext.reset(vertexCount);
+    backwardContext.reset(vertexCount);
+    forwardContext.setDistance(origin, 0.0, FlightGraph::invalidVertexId);
+    forwardContext.heap.push(0.0, origin);
+    backwardContext.setDistance(destination, 0.0, FlightGraph::invalidVertexId);
+    backwardContext.heap.push(0.0, destination);
+
+    double bestDistance = std::numeric_limits<double>::max();
+    meetingVertex = FlightGraph::invalidVertexId;
+
+    while (true) {
+        for (SearchContext* context : {&forwardContext, &backwardContext}) { //Discards stale entries, and finishes a search once it cannot improve the best distance
+            while (!context->heap.empty() && context->isSettled(context->heap.top().second)) {
+                context->heap.pop();
+            }
+            if (!context->heap.empty() && context->heap.top().first >= bestDistance) {
+                context->heap.clear();
+            }
+        }
+        if (forwardContext.heap.empty() && backwardContext.heap.empty()) {
+            break;
+        }
+
+        bool isForward = backwardContext.heap.empty() || (!forwardContext.heap.empty() && forwardContext.heap.top().first <= backwardContext.heap.top().first);
+        SearchContext& context = isForward ? forwardContext : backwardContext;
+        const SearchContext& otherContext = isForward ? backwardContext : forwardContext;
+
+        VertexId minVertex = context.heap.top().second;
+        double minDistance = context.heap.top().first;
+        context.heap.pop();
+        context.settle(minVertex);
+        if (otherContext.isReached(minVertex) && minDistance + otherContext.getDistance(minVertex) < bestDistance) {
+            bestDistance = minDistance + otherContext.getDistance(minVertex);
+            meetingVertex = minVertex;
+        }
+        if (isStalled(minVertex, isForward, context)) {
+            continue;
+        }
+
+        const std::vector<size_t>& offsets = isForward ? forwardOffsets : backwardOffsets;
+        const std::vector<VertexId>& targets = isForward ? forwardTargets : backwardTargets;
+        const std::vector<double>& weights = isForward ? forwardWeights : backwardWeights;
+        for (size_t i = offsets[minVertex]; i < offsets[minVertex + 1]; ++i) {
+            VertexId target = targets[i];
+            if (!context.isSettled(target) && minDistance + weights[i] < context.getDistance(target)) {
+                context.setDistance(target, minDistance + weights[i], minVertex);
+                context.heap.push(minDistance + weights[i], target);
+            }
+        }
+    }
+
+    return bestDistance;
+}
+
+//A vertex is stalled if a more important vertex reached by the same search has an edge into it that gives a shorter distance
+//Its shortest path then leaves the upward cone, so relaxing its edges cannot lead to the meeting vertex of a shortest path
+bool ContractionHierarchy::isStalled(VertexId vertex, bool isForward, const SearchContext& context) const {
+    const std::vector<size_t>& offsets = isForward ? backwardOffsets : forwardOffsets;
+    const std::vector<VertexId>& targets = isForward ? backwardTargets : forwardTargets;
+    const std::vector<double>& weights = isForward ? backwardWeights : forwardWeights;
+    double distance = context.getDistance(vertex);
+    for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+        if (context.isReached(targets[i]) && context.getDistance(targets[i]) + weights[i] < distance) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//The less important endpoint of a hierarchy edge stores it (see the notes on the upward search graphs)
+ContractionHierarchy::VertexId ContractionHierarchy::findMiddle(VertexId origin, VertexId destination) const {
+    if (rank[origin] < rank[destination]) {
+        for (size_t i = forwardOffsets[origin]; i < forwardOffsets[origin + 1]; ++i) {
+            if (forwardTargets[i] == destination) {
+                return forwardMiddles[i];
+            }
+        }
+    } else {
+        for (size_t i = backwardOffsets[destination]; i < backwardOffsets[destination + 1]; ++i) {
+            if (backwardTargets[i] == origin) {
+                return backwardMiddles[i];
+            }
+        }
+    }
+    return FlightGraph::invalidVertexId;
+}
+
+//A shortcut origin -> destination that bypasses middle is the pair of edges origin -> middle and middle -> destination, which may be shortcuts themselves
+//An explicit stack is used instead of recursion, since shortcuts can be nested deeply
+void ContractionHierarchy::unpackEdge(VertexId origin, VertexId destination, std::vector<VertexId>& shortestPath) const {
+    std::vector<std::pair<VertexId, VertexId>> stack {std::make_pair(origin, destination)};
+    while (!stack.empty()) {
+        std::pair<VertexId, VertexId> edge = stack.back();
+        stack.pop_back();
+        VertexId middle = findMiddle(edge.first, edge.second);
+        if (middle == FlightGraph::invalidVertexId) {
+            shortestPath.push_back(edge.second);
+        } else {
+            stack.push_back(std::make_pair(middle, edge.second));
+            stack.push_back(std::make_pair(edge.first, middle));
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "FlightGraph.h"
+#include "SearchContext.h"
+
+/*
+Notes:
+Contraction Hierarchies (https://en.wikipedia.org/wiki/Contraction_hierarchies)
+
+Preprocessing contracts the airports one at a time in order of importance
+Contracting an airport removes it from the remaining graph and adds a shortcut edge u -> w for every pair of remaining neighbors whose only shortest path ran through it
+Airports are ordered by edge difference (shortcuts added minus edges removed) plus the number of already contracted neighbors, which keeps the hierarchy balanced
+A shortcut is skipped if a witness search finds a path u -> w of the same length that avoids the contracted airport
+
+Queries run a bidirectional Dijkstra that only follows edges towards more important airports, so each search only explores a small upward cone
+Shortcuts remember the airport they bypass, so the query path is unpacked into the original routes
+
+The hierarchy is built from the graph's CSR arrays and keeps a pointer to the graph, so the graph must outlive the hierarchy
+*/
+
+class ContractionHierarchy {
+    public:
+        typedef FlightGraph::VertexId VertexId;
+
+        ContractionHierarchy(const FlightGraph& graph); //Contracts every airport of the graph and builds the upward search graphs
+
+        std::vector<std::string> findShortestPath(const std::string& originAirportCode, const std::string& destinationAirportCode) const; //Returns the shortest path (a vector of airport codes), in the same shape as FlightGraph::findShortestPath
+        std::vector<VertexId> findShortestPath(VertexId origin, VertexId destination) const; //Vertex ID version of findShortestPath(originAirportCode, destinationAirportCode), which uses the calling thread's search contexts
+        double findShortestPath(VertexId origin, VertexId destination, SearchContext& forwardContext, SearchContext& backwardContext, std::vector<VertexId>& shortestPath) const; //Writes the unpacked shortest path into shortestPath and returns its length (std::numeric_limits<double>::max() if the destination is unreachable)
+        double getDistance(VertexId origin, VertexId destination, SearchContext& forwardContext, SearchContext& backwardContext) const; //Returns the length of the shortest path without unpacking it
+
+        size_t getShortcutCount() const; //Returns the number of shortcut edges added during preprocessing
+
+        std::vector<size_t> rank; //Contraction order of each vertex (vertices contracted later are more important)
+
+        //Upward search graphs in CSR form (see FlightGraph for the CSR layout)
+        //The forward graph of u holds the edges u -> w with rank.at(w) > rank.at(u)
+        //The backward graph of w holds the edges u -> w with rank.at(u) > rank.at(w), stored at w with target u
+        //A middle vertex of FlightGraph::invalidVertexId marks an original route, and any other value marks a shortcut that bypasses that vertex
+        std::vector<size_t> forwardOffsets;
+        std::vector<VertexId> forwardTargets;
+        std::vector<double> forwardWeights;
+        std::vector<VertexId> forwardMiddles;
+
+        std::vector<size_t> backwardOffsets;
+        std::vector<VertexId> backwardTargets;
+        std::vector<double> backwardWeights;
+        std::vector<VertexId> backwardMiddles;
+
+    private:
+        const FlightGraph* graph;
+        size_t shortcutCount;
+
+        double search(VertexId origin, VertexId destination, SearchContext& forwardContext, SearchContext& backwardContext, VertexId& meetingVertex) const; //Bidirectional upward search - returns the distance and the vertex where the searches meet
+        bool isStalled(VertexId vertex, bool isForward, const SearchContext& context) const; //Stall-on-demand - returns whether a more important vertex already reaches this vertex with a shorter distance
+        VertexId findMiddle(VertexId origin, VertexId destination) const; //Returns the middle vertex of the hierarchy edge origin -> destination
+        void unpackEdge(VertexId origin, VertexId destination, std::vector<VertexId>& shortestPath) const; //Appends the original route of a hierarchy edge to shortestPath (excluding origin)
+};
@@ -0,0 +1,193 @@
+#include "CsvReader.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace {
+    bool isStructural(char character) {
+        return character == ',' || character == '"' || character == '\n';
+    }
+
+    std::uint64_t computeBlockMaskScalar(const char* block) {
+        std::uint64_t mask = 0;
+        for (size_t i = 0; i < 64; ++i) {
+            mask |= (std::uint64_t) isStructural(block[i]) << i;
+        }
+        return mask;
+    }
+
+    //Bitmask of a block that is cut short by the end of the text (bits past the end stay clear)
+    std::uint64_t computeTailMask(const char* block, size_t length) {
+        std::uint64_t mask = 0;
+        for (size_t i = 0; i < length; ++i) {
+            mask |= (std::uint64_t) isStructural(block[i]) << i;
+        }
+        return mask;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    //Compares 16 bytes at a time against each structural character and packs the matches with movemask (https://www.intel.com/content/www/us/en/docs/intrinsics-guide/index.html)
+    __attribute__((target("sse2"))) std::uint64_t computeBlockMaskSSE2(const char* block) {
+        const __m128i comma = _mm_set1_epi8(',');
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i newline = _mm_set1_epi8('\n');
+        std::uint64_t mask = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+            __m128i matches = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, comma), _mm_cmpeq_epi8(bytes, quote)), _mm_cmpeq_epi8(bytes, newline));
+            mask |= (std::uint64_t) (std::uint32_t) _mm_movemask_epi8(matches) << (16 * i);
+        }
+        return mask;
+    }
+
+    //Same as computeBlockMaskSSE2 with 32 bytes at a time
+    __attribute__((target("avx2"))) std::uint64_t computeBlockMaskAVX2(const char* block) {
+        const __m256i comma = _mm256_set1_epi8(',');
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i newline = _mm256_set1_epi8('\n');
+        std::uint64_t mask = 0;
+        for (size_t i = 0; i < 2; ++i) {
+            __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32 * i));
+            __m256i matches = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, comma), _mm256_cmpeq_epi8(bytes, quote)), _mm256_cmpeq_epi8(bytes, newline));
+            mask |= (std::uint64_t) (std::uint32_t) _mm256_movemask_epi8(matches) << (32 * i);
+        }
+        return mask;
+    }
+#endif
+}
+
+constexpr size_t CsvReader::blockSize;
+
+CsvReader::CsvReader(const char* begin, const char* end) : CsvReader(begin, end, getBestInstructions()) {
+}
+
+CsvReader::CsvReader(const char* begin, const char* end, Instructions instructions) : begin(begin), position(begin), end(end), computeBlockMask(computeBlockMaskScalar), blockStart(begin), blockEnd(begin), blockMask(0) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (instructions == Instructions::SSE2) {
+        computeBlockMask = computeBlockMaskSSE2;
+    } else if (instructions == Instructions::AVX2) {
+        computeBlockMask = computeBlockMaskAVX2;
+    }
+#endif
+}
+
+//Defined before readLine so the common case (from is in the cached block) is inlined
+inline const char* CsvReader::findStructural(const char* from) {
+    while (from < end) {
+        if (from < blockStart || from >= blockEnd) { //Computes the bitmask of the block that contains from
+            blockStart = begin + (from - begin) / blockSize * blockSize;
+            size_t length = std::min<size_t>(blockSize, end - blockStart);
+            blockEnd = blockStart + length;
+            blockMask = length == blockSize ? computeBlockMask(blockStart) : computeTailMask(blockStart, length);
+        }
+        std::uint64_t mask = blockMask & (~0ULL << (from - blockStart)); //Ignores the structural characters before from
+        if (mask != 0) {
+            return blockStart + __builtin_ctzll(mask);
+        }
+        from = blockEnd;
+    }
+    return end;
+}
+
+inline const char* CsvReader::findFieldEnd(const char* from) {
+    const char* character = findStructural(from);
+    while (character < end && *character == '"') {
+        character = findStructural(character + 1);
+    }
+    return character;
+}
+
+inline bool CsvReader::isLineEnd(const char* character) const {
+    return character == end || *character == '\n' || (*character == '\r' && (character + 1 == end || *(character + 1) == '\n'));
+}
+
+bool CsvReader::readLine(std::vector<std::string_view>& fields) {
+    fields.clear();
+    if (position == end) {
+        return false;
+    }
+
+    const char* fieldStart = position;
+    while (true) {
+        const char* fieldEnd = nullptr;
+        if (fieldStart < end && *fieldStart == '"') { //Quoted field - skip to the closing quotation mark
+            for (const char* quote = findStructural(fieldStart + 1); quote < end && *quote != '\n'; quote = findStructural(quote + 1)) {
+                if (*quote == '"' && (isLineEnd(quote + 1) || *(quote + 1) == ',')) {
+                    fieldEnd = quote + 1; //Keeps the closing quotation mark
+                    break;
+                }
+            }
+        }
+        if (fieldEnd == nullptr) { //Unquoted field (or a quoted field that is never closed)
+            fieldEnd = findFieldEnd(fieldStart);
+            if ((fieldEnd == end || *fieldEnd == '\n') && fieldEnd > fieldStart && *(fieldEnd - 1) == '\r') { //Drops the '\r' of a "\r\n" line ending
+                fields.push_back(std::string_view(fieldStart, fieldEnd - 1 - fieldStart));
+            } else {
+                fields.push_back(std::string_view(fieldStart, fieldEnd - fieldStart));
+            }
+        } else {
+            fields.push_back(std::string_view(fieldStart, fieldEnd - fieldStart));
+        }
+
+        if (fieldEnd == end || *fieldEnd != ',') { //End of the line (fieldEnd is at '\r', '\n', or the end of the text)
+            position = fieldEnd;
+            if (position < end && *position == '\r') {
+                ++position;
+            }
+            if (position < end && *position == '\n') {
+                ++position;
+            }
+            return true;
+        }
+        fieldStart = fieldEnd + 1; //Skips the comma
+    }
+}
+
+CsvReader::Instructions CsvReader::getBestInstructions() {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) {
+        return Instructions::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return Instructions::SSE2;
+    }
+#endif
+    return Instructions::Scalar;
+}
+
+std::vector<const char*> CsvReader::findChunkBoundaries(const char* begin, const char* end, size_t chunkCount) {
+    std::vector<const char*> boundaries;
+    boundaries.push_back(begin);
+    size_t size = end - begin;
+    for (size_t i = 1; i < chunkCount; ++i) {
+        const char* boundary = std::max(begin + size * i / chunkCount, boundaries.back());
+        if (boundary > begin && boundary < end && *(boundary - 1) != '\n') { //Moves the boundary past the end of the line it falls into
+            const char* lineEnd = static_cast<const char*>(std::memchr(boundary, '\n', end - boundary));
+            boundary = lineEnd == nullptr ? end : lineEnd + 1;
+        }
+        boundaries.push_back(boundary);
+    }
+    boundaries.push_back(end);
+    return boundaries;
+}
+
+double CsvReader::parseDouble(std::string_view field) {
+    char text[64]; //Numbers in the OpenFlights databases are far shorter, and longer fields are truncated (strtod stops at the first invalid character anyway)
+    size_t length = std::min(field.size(), sizeof(text) - 1);
+    std::memcpy(text, field.data(), length);
+    text[length] = '\0';
+
+    char* parsedEnd = nullptr;
+    double value = std::strtod(text, &parsedEnd);
+    if (parsedEnd == text) {
+        throw std::invalid_argument("CsvReader::parseDouble: " + std::string(field));
+    }
+    return value;
+}
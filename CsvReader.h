@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/*
+Notes:
+CsvReader splits comma-separated text into lines and fields without copying - every field is a std::string_view into the text, so the text must outlive the fields
+
+Lines end at '\n' (a trailing '\r' is dropped), and the last line does not need a newline
+A field that starts with a quotation mark ends at the quotation mark that is followed by a comma or the end of the line, so commas inside quoted airport names do not split the field
+Fields keep their quotation marks (e.g., "GKA" is returned with the quotes), so callers decide how to clean them
+
+The text is scanned 64 bytes at a time into a bitmask of its structural characters (commas, quotation marks, and newlines), and fields are cut by walking the set bits
+The bitmask is computed with AVX2 or SSE2 when the processor supports them (chosen at runtime), and with a scalar loop otherwise
+Every instruction set produces the same bitmask, so the fields never depend on the processor
+*/
+
+class CsvReader {
+    public:
+        enum class Instructions {Scalar, SSE2, AVX2}; //Instruction sets that can compute the structural bitmask
+
+        CsvReader(const char* begin, const char* end); //Reads the text in [begin, end) with the best instruction set the processor supports
+        CsvReader(const char* begin, const char* end, Instructions instructions); //Reads the text with the given instruction set (which must be supported)
+
+        bool readLine(std::vector<std::string_view>& fields); //Replaces fields with the fields of the next line - returns false if there are no lines left
+
+        static Instructions getBestInstructions(); //Returns the best instruction set the processor supports
+        static std::vector<const char*> findChunkBoundaries(const char* begin, const char* end, size_t chunkCount); //Splits [begin, end) into chunkCount chunks of about the same size that start on line boundaries - returns chunkCount + 1 boundaries (chunks may be empty)
+        static double parseDouble(std::string_view field); //Parses a number like std::stod (throws std::invalid_argument if the field does not start with a number)
+
+    private:
+        static constexpr size_t blockSize = 64; //Bytes per structural bitmask
+
+        const char* begin;
+        const char* position; //Start of the next line
+        const char* end;
+        std::uint64_t (*computeBlockMask)(const char* block); //Bitmask of the structural characters of a full block (bit i is set if block[i] is structural)
+
+        const char* blockStart; //Block whose bitmask is cached (empty before the first block)
+        const char* blockEnd; //End of the cached block (the last block is cut short by the end of the text)
+        std::uint64_t blockMask;
+
+        const char* findStructural(const char* from); //Returns the first comma, quotation mark, or newline at or after from (end if there is none)
+        const char* findFieldEnd(const char* from); //Returns the first comma or newline at or after from (end if there is none)
+        bool isLineEnd(const char* character) const; //Returns whether character is the end of a line (end, '\n', or a '\r' before one of them)
+};
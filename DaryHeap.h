@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+/*
+Notes:
+DaryHeap is a flat d-ary min-heap of (key, value) pairs stored in a single vector
+
+The default arity of 4 makes the tree half as deep as a binary heap and keeps the children of a node next to each other in memory
+
+Decrease-key is not supported - searches push a new entry whenever a key improves and skip the stale entries when they are popped (lazy insertion)
+
+Entries with equal keys are ordered by value, so the pop order is deterministic
+*/
+
+template <typename Value, size_t Arity = 4>
+class DaryHeap {
+    public:
+        typedef std::pair<double, Value> Entry; //(key, value)
+
+        bool empty() const; //Returns whether the heap has no entries
+        size_t size() const; //Returns the number of entries (including stale entries)
+        void clear(); //Removes all entries but keeps the allocated memory
+        void reserve(size_t capacity); //Preallocates memory for capacity entries
+
+        const Entry& top() const; //Returns the entry with the minimum key - note that calling this on an empty heap will result in undefined behavior
+        void push(double key, const Value& value); //Inserts an entry
+        void pop(); //Removes the entry with the minimum key - note that calling this on an empty heap will result in undefined behavior
+
+    private:
+        std::vector<Entry> entries; //Entries in heap order (the children of index i are at Arity * i + 1 to Arity * i + Arity)
+};
+
+template <typename Value, size_t Arity>
+bool DaryHeap<Value, Arity>::empty() const {
+    return entries.empty();
+}
+
+template <typename Value, size_t Arity>
+size_t DaryHeap<Value, Arity>::size() const {
+    return entries.size();
+}
+
+template <typename Value, size_t Arity>
+void DaryHeap<Value, Arity>::clear() {
+    entries.clear();
+}
+
+template <typename Value, size_t Arity>
+void DaryHeap<Value, Arity>::reserve(size_t capacity) {
+    entries.reserve(capacity);
+}
+
+template <typename Value, size_t Arity>
+const typename DaryHeap<Value, Arity>::Entry& DaryHeap<Value, Arity>::top() const {
+    return entries.front();
+}
+
+//Sift up (the new entry moves up while it is smaller than its parent)
+template <typename Value, size_t Arity>
+void DaryHeap<Value, Arity>::push(double key, const Value& value) {
+    Entry entry(key, value);
+    size_t index = entries.size();
+    entries.push_back(entry);
+    while (index > 0) {
+        size_t parent = (index - 1) / Arity;
+        if (!(entry < entries[parent])) {
+            break;
+        }
+        entries[index] = entries[parent];
+        index = parent;
+    }
+    entries[index] = entry;
+}
+
+//Sift down (the last entry moves down from the root while one of its children is smaller)
+template <typename Value, size_t Arity>
+void DaryHeap<Value, Arity>::pop() {
+    Entry entry = entries.back();
+    entries.pop_back();
+    if (entries.empty()) {
+        return;
+    }
+    size_t index = 0;
+    while (true) {
+        size_t firstChild = Arity * index + 1;
+        if (firstChild >= entries.size()) {
+            break;
+        }
+        size_t lastChild = firstChild + Arity < entries.size() ? firstChild + Arity : entries.size();
+        size_t minChild = firstChild;
+        for (size_t child = firstChild + 1; child < lastChild; ++child) {
+            if (entries[child] < entries[minChild]) {
+                minChild = child;
+            }
+        }
+        if (!(entries[minChild] < entry)) {
+            break;
+        }
+        entries[index] = entries[minChild];
+        index = minChild;
+    }
+    entries[index] = entry;
+}
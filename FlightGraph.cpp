@@ -1,98 +1,449 @@
 #include "FlightGraph.h"
 
-//Read lines of file (https://stackoverflow.com/questions/13035674/how-to-read-line-by-line-or-a-whole-text-file-at-once)
-//Process comma-delimited string (https://www.tutorialspoint.com/parsing-a-comma-delimited-std-string-in-cplusplus)
-FlightGraph::FlightGraph(const std::string& routeFilepath, const std::string& airportFilepath) {
-    //Reads routes.dat and assigns airportCodeMap and edgeSet
-    std::ifstream routesFile(routeFilepath);
-    std::string routeCurrentLine;
-    while (std::getline(routesFile, routeCurrentLine)) {
-        std::vector<std::string> substringVector;
+constexpr FlightGraph::VertexId FlightGraph::invalidVertexId;
+constexpr double FlightGraph::radiusOfEarth;
+constexpr size_t FlightGraph::iataTableSize;
+constexpr double FlightGraph::unreachableLegCost;
+constexpr size_t FlightGraph::ShortestPathTreeCache::defaultMemoryBudget;
 
-        std::stringstream lineStream(routeCurrentLine);
-        std::string currentSubstring;
-        while (std::getline(lineStream, currentSubstring, ',')) {
-            substringVector.push_back(currentSubstring);
+namespace {
+    //Routes of one chunk of the route file, which is parsed independently of the other chunks
+    struct RouteChunk {
+        std::vector<AirportCode> codes; //Distinct airport codes of the chunk, indexed by chunk-local ID
+        std::vector<std::pair<FlightGraph::VertexId, FlightGraph::VertexId>> edges; //Routes in chunk-local IDs (final IDs after assignFinalIds)
+        std::string invalidCode; //First code of the chunk that cannot be packed (empty if there is none)
+
+        void parse(const char* begin, const char* end) {
+            CsvReader reader(begin, end);
+            std::unordered_map<AirportCode, FlightGraph::VertexId> localIds;
+            std::vector<std::string_view> fields;
+            auto getLocalId = [&](AirportCode code) {
+                auto inserted = localIds.emplace(code, (FlightGraph::VertexId) codes.size());
+                if (inserted.second) {
+                    codes.push_back(code);
+                }
+                return inserted.first->second;
+            };
+            while (reader.readLine(fields)) {
+                if (fields.size() < 5) { //Skips blank and truncated lines
+                    continue;
+                }
+                if (!AirportCode::isValid(fields[2]) || !AirportCode::isValid(fields[4])) { //Exceptions cannot leave a worker thread, so the constructor throws after the chunks are joined
+                    invalidCode = std::string(AirportCode::isValid(fields[2]) ? fields[4] : fields[2]);
+                    return;
+                }
+                FlightGraph::VertexId origin = getLocalId(AirportCode(fields[2]));
+                FlightGraph::VertexId destination = getLocalId(AirportCode(fields[4]));
+                edges.push_back(std::make_pair(origin, destination));
+            }
+        }
+
+        //Converts the edges to final IDs (the indices of the codes in sortedCodes), and sorts them and removes duplicates so the merge has less work to do
+        void assignFinalIds(const std::vector<AirportCode>& sortedCodes) {
+            std::vector<FlightGraph::VertexId> finalIds;
+            finalIds.reserve(codes.size());
+            for (AirportCode code : codes) {
+                finalIds.push_back((FlightGraph::VertexId) (std::lower_bound(sortedCodes.begin(), sortedCodes.end(), code) - sortedCodes.begin()));
+            }
+            for (std::pair<FlightGraph::VertexId, FlightGraph::VertexId>& edge : edges) {
+                edge = std::make_pair(finalIds[edge.first], finalIds[edge.second]);
+            }
+            std::sort(edges.begin(), edges.end());
+            edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
         }
+    };
+
+    //Fixed-size start of a snapshot file, followed by the payload sections (see saveSnapshot)
+    struct SnapshotHeader {
+        char magic[8]; //"FGSNAP" followed by two zero bytes
+        std::uint32_t version;
+        std::uint32_t byteOrderMark; //0x01020304 as written, so files from a machine with another byte order are rejected
+        std::uint64_t vertexCount;
+        std::uint64_t edgeCount; //Edges of the CSR arrays
+        std::uint64_t routeCount; //Entries of edgeList (which includes routes without a positive distance)
+        std::uint64_t codeByteCount; //Total length of the airport codes
+        std::uint64_t payloadSize; //Bytes after the header
+        std::uint64_t checksum; //FNV-1a hash of the payload
+    };
+
+    constexpr std::uint32_t snapshotVersion = 1;
+    constexpr std::uint32_t snapshotByteOrderMark = 0x01020304;
 
-        airportCodeMap[substringVector.at(2)] = 0;
-        airportCodeMap[substringVector.at(4)] = 0;
+    //(https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function)
+    //hash continues an earlier checksum, so several arrays can be hashed in sequence
+    std::uint64_t computeChecksum(const char* data, size_t size, std::uint64_t hash = 14695981039346656037ULL) {
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ (unsigned char) data[i]) * 1099511628211ULL;
+        }
+        return hash;
+    }
 
-        edgeSet.insert(std::make_pair(substringVector.at(2), substringVector.at(4)));
+    //Appends a section to a snapshot payload, padded to a multiple of 8 bytes so that every section stays aligned in the mapped file
+    void appendSection(std::string& payload, const void* data, size_t size) {
+        payload.append(static_cast<const char*>(data), size);
+        payload.append((8 - size % 8) % 8, '\0');
     }
 
-    //Updates the values (indices) of airportCodeMap and assigns airportCodeList
-    int i = 0;
-    for (auto itr = airportCodeMap.begin(); itr != airportCodeMap.end(); ++itr) {
-        itr->second = i;
-        airportCodeList.push_back(itr->first);
-        ++i;
+    //Reads the next section of a snapshot payload - returns nullptr if the payload is too short
+    const char* readSection(const char*& cursor, const char* end, std::uint64_t size) {
+        std::uint64_t paddedSize = size + (8 - size % 8) % 8;
+        if (paddedSize < size || paddedSize > (std::uint64_t) (end - cursor)) {
+            return nullptr;
+        }
+        const char* section = cursor;
+        cursor += paddedSize;
+        return section;
     }
 
-    //Assigns edgeList
-    for (auto itr = edgeSet.begin(); itr != edgeSet.end(); ++itr) {
-        edgeList.push_back(*itr);
+    //Checks that offsets is a valid CSR offset array over itemCount items
+    bool isValidOffsets(const std::vector<size_t>& offsets, size_t itemCount) {
+        if (offsets.empty() || offsets.front() != 0 || offsets.back() != itemCount) {
+            return false;
+        }
+        for (size_t i = 1; i < offsets.size(); ++i) {
+            if (offsets.at(i - 1) > offsets.at(i)) {
+                return false;
+            }
+        }
+        return true;
     }
 
-    //Assigns adjacencyMatrix
-    adjacencyMatrix = std::vector<std::vector<double>>(airportCodeList.size(), std::vector<double>(airportCodeList.size(), -1.0));
-    for (const std::pair<std::string, std::string>& edge : edgeList) {
-        adjacencyMatrix.at(airportCodeMap.at(edge.first)).at(airportCodeMap.at(edge.second)) = 1.0;
+    //Calls task(0), ..., task(taskCount - 1) on taskCount threads (the calling thread runs task(0))
+    template <typename Task>
+    void runInParallel(size_t taskCount, const Task& task) {
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < taskCount; ++i) {
+            threads.push_back(std::thread(task, i));
+        }
+        if (taskCount > 0) {
+            task(0);
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    //Calls runChunk(chunk) for every chunk, as tasks on the pool if isParallel is true and on the calling thread otherwise
+    template <typename RunChunk>
+    void runChunks(ThreadPool& pool, size_t chunkCount, bool isParallel, const RunChunk& runChunk) {
+        if (isParallel) {
+            pool.run(chunkCount, [&](size_t chunk, size_t) { runChunk(chunk); });
+        } else {
+            for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+                runChunk(chunk);
+            }
+        }
+    }
+
+    //Each set is a tree of parent pointers whose root is its smallest vertex, since a root is only ever linked below a smaller root
+    //Linking a root is a compare-and-swap, so it fails (and the union is retried) if another thread linked the root first
+    //Finds use path halving, which only ever replaces a parent with one of its ancestors, so concurrent halving keeps every tree valid (Jayanti and Tarjan, https://arxiv.org/abs/1612.01514)
+    FlightGraph::VertexId findComponentRoot(std::atomic<FlightGraph::VertexId>* parents, FlightGraph::VertexId vertex) {
+        while (true) {
+            FlightGraph::VertexId parent = parents[vertex].load(std::memory_order_relaxed);
+            if (parent == vertex) {
+                return vertex;
+            }
+            FlightGraph::VertexId grandparent = parents[parent].load(std::memory_order_relaxed);
+            if (grandparent != parent) {
+                parents[vertex].compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+            }
+            vertex = grandparent;
+        }
+    }
+}
+
+//The route and airport files are memory-mapped and tokenized in place (see MappedFile and CsvReader), so no per-line strings are allocated
+FlightGraph::FlightGraph(const std::string& routeFilepath, const std::string& airportFilepath, size_t threadCount) {
+    //Reads routes.dat in chunks that start on line boundaries, and each chunk gives its airport codes chunk-local IDs in order of first appearance
+    //Codes are packed into AirportCode values, so interning and sorting them compares integers instead of strings
+    MappedFile routesFile(routeFilepath);
+    std::vector<const char*> chunkBoundaries = CsvReader::findChunkBoundaries(routesFile.data(), routesFile.data() + routesFile.size(), std::max<size_t>(threadCount, 1));
+    std::vector<RouteChunk> chunks(chunkBoundaries.size() - 1);
+    runInParallel(chunks.size(), [&](size_t i) {
+        chunks.at(i).parse(chunkBoundaries.at(i), chunkBoundaries.at(i + 1));
+    });
+    for (const RouteChunk& chunk : chunks) {
+        if (!chunk.invalidCode.empty()) {
+            throw std::invalid_argument("FlightGraph: \"" + chunk.invalidCode + "\" is not an airport code of at most " + std::to_string(AirportCode::maxLength) + " characters");
+        }
     }
 
-    //Reads airports-extended.dat and assigns airportCodeToLatitudeLongitudeMap
-    std::ifstream airportFile(airportFilepath);
-    std::string airportCurrentLine;
-    while (std::getline(airportFile, airportCurrentLine)) {
-        std::vector<std::string> substringVector;
+    //Final IDs follow the sorted order of the codes (the order airportCodeMap has always used, since packed codes sort like strings)
+    for (const RouteChunk& chunk : chunks) {
+        airportCodes.insert(airportCodes.end(), chunk.codes.begin(), chunk.codes.end());
+    }
+    std::sort(airportCodes.begin(), airportCodes.end());
+    airportCodes.erase(std::unique(airportCodes.begin(), airportCodes.end()), airportCodes.end());
+    airportCodeList.reserve(airportCodes.size());
+    for (VertexId i = 0; i < airportCodes.size(); ++i) {
+        airportCodeList.push_back(airportCodes.at(i).toString());
+        airportCodeMap.emplace_hint(airportCodeMap.end(), airportCodeList.back(), (int) i);
+    }
+    buildIataTable();
+
+    //Each chunk converts its edges to final IDs, and sorting the edges by final ID matches the order of edgeSet (codes and IDs sort the same way)
+    //unique removes duplicate routes, so the result does not depend on the number of chunks
+    runInParallel(chunks.size(), [&](size_t i) {
+        chunks.at(i).assignFinalIds(airportCodes);
+    });
+    std::vector<std::pair<VertexId, VertexId>> edges;
+    for (const RouteChunk& chunk : chunks) {
+        edges.insert(edges.end(), chunk.edges.begin(), chunk.edges.end());
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    edgeList.reserve(edges.size());
+    for (const std::pair<VertexId, VertexId>& edge : edges) {
+        edgeList.push_back(std::make_pair(airportCodeList.at(edge.first), airportCodeList.at(edge.second)));
+        edgeSet.emplace_hint(edgeSet.end(), edgeList.back());
+    }
 
-        std::stringstream lineStream(airportCurrentLine);
-        std::string currentSubstring;
-        while (std::getline(lineStream, currentSubstring, ',')) {
-            substringVector.push_back(currentSubstring);
+    //Reads airports-extended.dat and assigns the coordinates of every airport in the graph
+    //Airports without a known coordinate are assigned to the South Pole
+    std::vector<std::pair<double, double>> coordinates(airportCodeList.size(), std::make_pair(-90.0, 0.0));
+    MappedFile airportFile(airportFilepath);
+    CsvReader airportReader(airportFile.data(), airportFile.data() + airportFile.size());
+    std::vector<std::string_view> fields;
+    while (airportReader.readLine(fields)) {
+        if (fields.size() < 8) { //Skips blank and truncated lines
+            continue;
+        }
+        std::string_view currentCode = fields[4];
+        if (currentCode.size() > 3) { //Checks if the current code is valid
+            std::string_view cleanedCode = currentCode.substr(1, currentCode.size() - 2); //Removes the first and last character, which are usually quotation marks
+            VertexId vertex = AirportCode::isValid(cleanedCode) ? findVertexId(AirportCode(cleanedCode)) : invalidVertexId;
+            if (vertex != invalidVertexId) { //Checks if the current code is an airport of the graph
+                coordinates.at(vertex) = std::make_pair(CsvReader::parseDouble(fields[6]), CsvReader::parseDouble(fields[7]));
+            }
         }
+    }
+    for (VertexId vertex = 0; vertex < airportCodeList.size(); ++vertex) {
+        airportCodeToLatitudeLongitudeMap.emplace_hint(airportCodeToLatitudeLongitudeMap.end(), airportCodeList.at(vertex), coordinates.at(vertex));
+    }
+
+    //Assigns unitSphereVectors (https://en.wikipedia.org/wiki/N-vector)
+    double PI = std::atan(1.0) * 4.0;
+    unitSphereVectors.reserve(3 * airportCodeList.size());
+    for (const std::pair<double, double>& coordinate : coordinates) {
+        double latitudeRadians = coordinate.first * PI / 180.0;
+        double longitudeRadians = coordinate.second * PI / 180.0;
+        unitSphereVectors.push_back(std::cos(latitudeRadians) * std::cos(longitudeRadians));
+        unitSphereVectors.push_back(std::cos(latitudeRadians) * std::sin(longitudeRadians));
+        unitSphereVectors.push_back(std::sin(latitudeRadians));
+    }
 
-        int offset = (int) substringVector.size() - 14; //Some airport names contain extra commas, so I use an offset to correct this issue
-        const std::string& currentCode = substringVector.at(4 + offset);
-        const std::string& cleanedCode = currentCode.substr(1, currentCode.size() - 2); //Removes the first and last character, which are usually quotation marks
-        if (currentCode.size() > 3 && airportCodeMap.count(cleanedCode) == 1) { //Checks if the current code is valid and is an element of airportCodeMap
-            airportCodeToLatitudeLongitudeMap[cleanedCode] = std::make_pair(std::stod(substringVector.at(6 + offset)), std::stod(substringVector.at(7 + offset)));
+    //Assigns the CSR arrays (adjacencyOffsets, adjacencyTargets, and adjacencyWeights)
+    //edges is sorted by origin and then by destination, so each row is contiguous and its targets are sorted by index
+    adjacencyOffsets = std::vector<size_t>(airportCodeList.size() + 1, 0);
+    adjacencyTargets.reserve(edges.size());
+    adjacencyWeights.reserve(edges.size());
+    for (const std::pair<VertexId, VertexId>& edge : edges) {
+        double distance = convertCoordinatesToKilometers(coordinates.at(edge.first), coordinates.at(edge.second));
+        if (distance > 0.0) { //Edges without a positive distance are treated as nonexistent
+            adjacencyTargets.push_back(edge.second);
+            adjacencyWeights.push_back(distance);
+            ++adjacencyOffsets.at(edge.first + 1);
         }
     }
+    for (size_t i = 0; i < airportCodeList.size(); ++i) { //Converts the row sizes into row offsets (prefix sum)
+        adjacencyOffsets.at(i + 1) += adjacencyOffsets.at(i);
+    }
 
-    //Assigns any missing coordinates to the South Pole
-    for (auto itr = airportCodeMap.begin(); itr != airportCodeMap.end(); ++itr) {
-        if (airportCodeToLatitudeLongitudeMap.count(itr->first) == 0) {
-            airportCodeToLatitudeLongitudeMap[itr->first] = std::make_pair(-90.0, 0.0);
+    //Assigns the reverse CSR arrays by bucketing the edges by destination (origins are visited in increasing order, so each reverse row is sorted)
+    reverseAdjacencyOffsets = std::vector<size_t>(airportCodeList.size() + 1, 0);
+    for (VertexId target : adjacencyTargets) {
+        ++reverseAdjacencyOffsets.at(target + 1);
+    }
+    for (size_t i = 0; i < airportCodeList.size(); ++i) {
+        reverseAdjacencyOffsets.at(i + 1) += reverseAdjacencyOffsets.at(i);
+    }
+    reverseAdjacencyTargets = std::vector<VertexId>(adjacencyTargets.size());
+    reverseAdjacencyWeights = std::vector<double>(adjacencyWeights.size());
+    std::vector<size_t> nextPosition(reverseAdjacencyOffsets.begin(), reverseAdjacencyOffsets.end() - 1); //Next free position of each reverse row
+    for (VertexId origin = 0; origin < airportCodeList.size(); ++origin) {
+        for (size_t i = adjacencyOffsets.at(origin); i < adjacencyOffsets.at(origin + 1); ++i) {
+            size_t position = nextPosition.at(adjacencyTargets.at(i))++;
+            reverseAdjacencyTargets.at(position) = origin;
+            reverseAdjacencyWeights.at(position) = adjacencyWeights.at(i);
         }
     }
+}
+
+FlightGraph::FlightGraph() : adjacencyOffsets(1, 0), reverseAdjacencyOffsets(1, 0) {
+    buildIataTable();
+}
 
-    //Modifies the positive entries of adjacencyMatrix such that the magnitude of each value is the distance between the airports in kilometers (i.e., the nonexistent edges are ignored)
+//The payload is a list of sections, each padded to 8 bytes:
+//code offsets (uint64, vertexCount + 1), code characters, coordinates (latitude and longitude per vertex), unitSphereVectors,
+//adjacencyOffsets (uint64), adjacencyTargets, adjacencyWeights, the three reverse CSR arrays, and edgeList as pairs of vertex IDs
+bool FlightGraph::saveSnapshot(const std::string& filepath) const {
+    std::vector<std::uint64_t> codeOffsets(1, 0);
+    std::string codeCharacters;
+    std::vector<double> coordinates;
+    for (const std::string& code : airportCodeList) {
+        codeCharacters += code;
+        codeOffsets.push_back(codeCharacters.size());
+        const std::pair<double, double>& coordinate = airportCodeToLatitudeLongitudeMap.at(code);
+        coordinates.push_back(coordinate.first);
+        coordinates.push_back(coordinate.second);
+    }
+    std::vector<std::uint64_t> offsets(adjacencyOffsets.begin(), adjacencyOffsets.end());
+    std::vector<std::uint64_t> reverseOffsets(reverseAdjacencyOffsets.begin(), reverseAdjacencyOffsets.end());
+    std::vector<VertexId> routes;
+    routes.reserve(2 * edgeList.size());
     for (const std::pair<std::string, std::string>& edge : edgeList) {
-        adjacencyMatrix.at(airportCodeMap.at(edge.first)).at(airportCodeMap.at(edge.second)) = convertCoordinatesToKilometers(airportCodeToLatitudeLongitudeMap.at(edge.first), airportCodeToLatitudeLongitudeMap.at(edge.second));
+        routes.push_back(getVertexId(edge.first));
+        routes.push_back(getVertexId(edge.second));
+    }
+
+    std::string payload;
+    appendSection(payload, codeOffsets.data(), codeOffsets.size() * sizeof(std::uint64_t));
+    appendSection(payload, codeCharacters.data(), codeCharacters.size());
+    appendSection(payload, coordinates.data(), coordinates.size() * sizeof(double));
+    appendSection(payload, unitSphereVectors.data(), unitSphereVectors.size() * sizeof(double));
+    appendSection(payload, offsets.data(), offsets.size() * sizeof(std::uint64_t));
+    appendSection(payload, adjacencyTargets.data(), adjacencyTargets.size() * sizeof(VertexId));
+    appendSection(payload, adjacencyWeights.data(), adjacencyWeights.size() * sizeof(double));
+    appendSection(payload, reverseOffsets.data(), reverseOffsets.size() * sizeof(std::uint64_t));
+    appendSection(payload, reverseAdjacencyTargets.data(), reverseAdjacencyTargets.size() * sizeof(VertexId));
+    appendSection(payload, reverseAdjacencyWeights.data(), reverseAdjacencyWeights.size() * sizeof(double));
+    appendSection(payload, routes.data(), routes.size() * sizeof(VertexId));
+
+    SnapshotHeader header = {{'F', 'G', 'S', 'N', 'A', 'P', '\0', '\0'}, snapshotVersion, snapshotByteOrderMark, airportCodeList.size(), adjacencyTargets.size(), edgeList.size(), codeCharacters.size(), payload.size(), computeChecksum(payload.data(), payload.size())};
+
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(payload.data(), payload.size());
+    return (bool) file;
+}
+
+//The file is mapped and every array is copied out of the mapping in one piece, so nothing is parsed and no distances are recomputed
+//The arrays are copied rather than used in place, since the graph's members are standard containers that do not outlive the mapping - the checksum and the string maps already take O(size) time, and the copies are a small part of the load (see README.md)
+bool FlightGraph::loadSnapshot(const std::string& filepath) {
+    MappedFile file(filepath);
+    SnapshotHeader header;
+    if (file.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    const char* cursor = file.data() + sizeof(header);
+    const char* end = file.data() + file.size();
+    if (std::memcmp(header.magic, "FGSNAP\0\0", 8) != 0 || header.version != snapshotVersion || header.byteOrderMark != snapshotByteOrderMark || header.payloadSize != (std::uint64_t) (end - cursor)) {
+        return false;
+    }
+    if (header.vertexCount >= invalidVertexId || header.edgeCount > header.payloadSize || header.routeCount > header.payloadSize || header.codeByteCount > header.payloadSize || computeChecksum(cursor, end - cursor) != header.checksum) { //The size checks keep the section sizes below from overflowing
+        return false;
+    }
+
+    size_t vertexCount = header.vertexCount;
+    size_t edgeCount = header.edgeCount;
+    const char* codeOffsetsSection = readSection(cursor, end, (vertexCount + 1) * sizeof(std::uint64_t));
+    const char* codeCharactersSection = readSection(cursor, end, header.codeByteCount);
+    const char* coordinatesSection = readSection(cursor, end, 2 * vertexCount * sizeof(double));
+    const char* unitSphereSection = readSection(cursor, end, 3 * vertexCount * sizeof(double));
+    const char* offsetsSection = readSection(cursor, end, (vertexCount + 1) * sizeof(std::uint64_t));
+    const char* targetsSection = readSection(cursor, end, edgeCount * sizeof(VertexId));
+    const char* weightsSection = readSection(cursor, end, edgeCount * sizeof(double));
+    const char* reverseOffsetsSection = readSection(cursor, end, (vertexCount + 1) * sizeof(std::uint64_t));
+    const char* reverseTargetsSection = readSection(cursor, end, edgeCount * sizeof(VertexId));
+    const char* reverseWeightsSection = readSection(cursor, end, edgeCount * sizeof(double));
+    const char* routesSection = readSection(cursor, end, 2 * header.routeCount * sizeof(VertexId));
+    if (routesSection == nullptr || cursor != end) { //readSection keeps returning nullptr once the payload runs out, so checking the last section is enough
+        return false;
+    }
+
+    const std::uint64_t* codeOffsets = reinterpret_cast<const std::uint64_t*>(codeOffsetsSection);
+    const double* coordinates = reinterpret_cast<const double*>(coordinatesSection);
+    const VertexId* routes = reinterpret_cast<const VertexId*>(routesSection);
+    std::vector<size_t> newOffsets(reinterpret_cast<const std::uint64_t*>(offsetsSection), reinterpret_cast<const std::uint64_t*>(offsetsSection) + vertexCount + 1);
+    std::vector<VertexId> newTargets(reinterpret_cast<const VertexId*>(targetsSection), reinterpret_cast<const VertexId*>(targetsSection) + edgeCount);
+    std::vector<size_t> newReverseOffsets(reinterpret_cast<const std::uint64_t*>(reverseOffsetsSection), reinterpret_cast<const std::uint64_t*>(reverseOffsetsSection) + vertexCount + 1);
+    std::vector<VertexId> newReverseTargets(reinterpret_cast<const VertexId*>(reverseTargetsSection), reinterpret_cast<const VertexId*>(reverseTargetsSection) + edgeCount);
+
+    //Validates the structure, so a file that passes the checksum but was built by a different program cannot cause out-of-bounds reads later
+    if (codeOffsets[0] != 0 || codeOffsets[vertexCount] != header.codeByteCount || !isValidOffsets(newOffsets, edgeCount) || !isValidOffsets(newReverseOffsets, edgeCount)) {
+        return false;
+    }
+    for (size_t i = 0; i < edgeCount; ++i) {
+        if (newTargets.at(i) >= vertexCount || newReverseTargets.at(i) >= vertexCount) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < 2 * header.routeCount; ++i) {
+        if (routes[i] >= vertexCount) {
+            return false;
+        }
+    }
+    std::vector<std::string> newCodeList;
+    newCodeList.reserve(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        if (codeOffsets[i] > codeOffsets[i + 1]) {
+            return false;
+        }
+        newCodeList.push_back(std::string(codeCharactersSection + codeOffsets[i], codeOffsets[i + 1] - codeOffsets[i]));
+        if (!AirportCode::isValid(newCodeList.at(i)) || (i > 0 && !(newCodeList.at(i - 1) < newCodeList.at(i)))) { //Vertex IDs must follow the sorted order of the codes
+            return false;
+        }
+    }
+
+    airportCodeList = newCodeList;
+    airportCodes.clear();
+    for (const std::string& code : airportCodeList) {
+        airportCodes.push_back(AirportCode(code));
+    }
+    buildIataTable();
+    airportCodeMap.clear();
+    airportCodeToLatitudeLongitudeMap.clear();
+    for (VertexId vertex = 0; vertex < vertexCount; ++vertex) {
+        airportCodeMap.emplace_hint(airportCodeMap.end(), airportCodeList.at(vertex), (int) vertex);
+        airportCodeToLatitudeLongitudeMap.emplace_hint(airportCodeToLatitudeLongitudeMap.end(), airportCodeList.at(vertex), std::make_pair(coordinates[2 * vertex], coordinates[2 * vertex + 1]));
+    }
+    edgeList.clear();
+    edgeSet.clear();
+    edgeList.reserve(header.routeCount);
+    for (size_t i = 0; i < header.routeCount; ++i) {
+        edgeList.push_back(std::make_pair(airportCodeList.at(routes[2 * i]), airportCodeList.at(routes[2 * i + 1])));
+        edgeSet.emplace_hint(edgeSet.end(), edgeList.back());
     }
+    unitSphereVectors.assign(reinterpret_cast<const double*>(unitSphereSection), reinterpret_cast<const double*>(unitSphereSection) + 3 * vertexCount);
+    adjacencyOffsets = newOffsets;
+    adjacencyTargets = newTargets;
+    adjacencyWeights.assign(reinterpret_cast<const double*>(weightsSection), reinterpret_cast<const double*>(weightsSection) + edgeCount);
+    reverseAdjacencyOffsets = newReverseOffsets;
+    reverseAdjacencyTargets = newReverseTargets;
+    reverseAdjacencyWeights.assign(reinterpret_cast<const double*>(reverseWeightsSection), reinterpret_cast<const double*>(reverseWeightsSection) + edgeCount);
+
+    //Landmarks and cached shortest path trees belong to the previous graph
+    shortestPathTreeCache.clear();
+    landmarks.clear();
+    landmarkDistancesFrom.clear();
+    landmarkDistancesTo.clear();
+    return true;
 }
 
 //Retrieves incident airport codes
 std::vector<std::string> FlightGraph::getIncidentAirportCodes(const std::string& originAirportCode) {
+    const NeighborRange& incident = neighbors(getVertexId(originAirportCode));
     std::vector<std::string> adjacencyList;
-    for (const std::string& currentAirportCode : airportCodeList) {
-        if (areAdjacent(originAirportCode, currentAirportCode)) {
-            adjacencyList.push_back(currentAirportCode);
-        }
+    adjacencyList.reserve(incident.size());
+    for (VertexId target : incident) {
+        adjacencyList.push_back(airportCodeList.at(target));
     }
     return adjacencyList;
 }
 
 //Checks whether two airports are adjacent
 bool FlightGraph::areAdjacent(const std::string& originAirportCode, const std::string& destinationAirportCode) {
-    return adjacencyMatrix.at(airportCodeMap.at(originAirportCode)).at(airportCodeMap.at(destinationAirportCode)) > 0.0;
+    return areAdjacent(getVertexId(originAirportCode), getVertexId(destinationAirportCode));
 }
 
 //Great-circle distance (https://en.wikipedia.org/wiki/Haversine_formula)
 //(https://stackoverflow.com/questions/21867617/best-platform-independent-pi-constant)
 double FlightGraph::convertCoordinatesToKilometers(const std::pair<double, double>& originCoordinates, const std::pair<double, double>& destinationCoordinates) {
-    double radiusOfEarth = 6378.137;
     double PI = std::atan(1.0) * 4.0;
 
     double originLatitudeRadians = originCoordinates.first * PI / 180.0;
@@ -107,38 +458,194 @@ double FlightGraph::convertCoordinatesToKilometers(const std::pair<double, doubl
 }
 
 std::vector<std::vector<std::string>> FlightGraph::breadthFirstSearch(const std::string& rootAirportCode) {
-    std::vector<bool> visited = std::vector<bool>(airportCodeList.size(), false);
+    const std::vector<std::vector<VertexId>>& components = breadthFirstSearch(getVertexId(rootAirportCode));
 
     std::vector<std::vector<std::string>> bfs;
-
-    bfs.push_back(breadthFirstSearch(rootAirportCode, visited));
-
-    for (const std::string& code : airportCodeList) {
-        if (!visited.at(airportCodeMap.at(code))) {
-            bfs.push_back(breadthFirstSearch(code, visited)); //Insert traversal of new component into bfs
+    bfs.reserve(components.size());
+    for (const std::vector<VertexId>& component : components) {
+        std::vector<std::string> traversal;
+        traversal.reserve(component.size());
+        for (VertexId vertex : component) {
+            traversal.push_back(airportCodeList.at(vertex));
         }
+        bfs.push_back(traversal);
     }
-
     return bfs;
 }
 
 //Helper function for BFS above 
 std::vector<std::string> FlightGraph::breadthFirstSearch(const std::string& airportCode, std::vector<bool>& visited) {
+    const std::vector<VertexId>& component = breadthFirstSearch(getVertexId(airportCode), visited);
+
     std::vector<std::string> traversal;
+    traversal.reserve(component.size());
+    for (VertexId vertex : component) {
+        traversal.push_back(airportCodeList.at(vertex));
+    }
+    return traversal;
+}
+
+std::vector<std::string> FlightGraph::findShortestPath(const std::string& originAirportCode, const std::string& destinationAirportCode, ShortestPathAlgorithm algorithm) {
+    const std::vector<VertexId>& path = findShortestPath(getVertexId(originAirportCode), getVertexId(destinationAirportCode), algorithm);
+
+    std::vector<std::string> shortestPath;
+    shortestPath.reserve(path.size());
+    for (VertexId vertex : path) {
+        shortestPath.push_back(airportCodeList.at(vertex));
+    }
+    return shortestPath;
+}
 
-    std::queue<std::string> queue;
-    visited.at(airportCodeMap.at(airportCode)) = true;
+std::vector<std::string> FlightGraph::findShortestLandmarkPath(const std::vector<std::string>& airportCodeVector, WaypointOrder order) {
+    std::vector<VertexId> vertexVector;
+    vertexVector.reserve(airportCodeVector.size());
+    for (const std::string& code : airportCodeVector) {
+        vertexVector.push_back(getVertexId(code));
+    }
+
+    const std::vector<VertexId>& path = findShortestLandmarkPath(vertexVector, order);
+
+    std::vector<std::string> shortestLandmarkPath;
+    shortestLandmarkPath.reserve(path.size());
+    for (VertexId vertex : path) {
+        shortestLandmarkPath.push_back(airportCodeList.at(vertex));
+    }
+    return shortestLandmarkPath;
+}
+
+size_t FlightGraph::getVertexCount() const {
+    return airportCodeList.size();
+}
+
+FlightGraph::VertexId FlightGraph::getVertexId(const std::string& airportCode) const {
+    VertexId vertex = AirportCode::isValid(airportCode) ? findVertexId(AirportCode(airportCode)) : invalidVertexId;
+    if (vertex == invalidVertexId) {
+        throw std::out_of_range("FlightGraph::getVertexId: unknown airport code " + airportCode);
+    }
+    return vertex;
+}
 
-    queue.push(airportCode);
+FlightGraph::VertexId FlightGraph::getVertexId(AirportCode airportCode) const {
+    VertexId vertex = findVertexId(airportCode);
+    if (vertex == invalidVertexId) {
+        throw std::out_of_range("FlightGraph::getVertexId: unknown airport code " + airportCode.toString());
+    }
+    return vertex;
+}
+
+//3-letter uppercase codes (every code in routes.dat) are read straight from iataVertexIds
+//Other codes (e.g., 4-letter ICAO codes) fall back to a binary search over airportCodes, which is sorted
+FlightGraph::VertexId FlightGraph::findVertexId(AirportCode airportCode) const {
+    size_t index = getIataIndex(airportCode);
+    if (index < iataVertexIds.size()) {
+        return iataVertexIds[index];
+    }
+    auto itr = std::lower_bound(airportCodes.begin(), airportCodes.end(), airportCode);
+    return itr != airportCodes.end() && *itr == airportCode ? (VertexId) (itr - airportCodes.begin()) : invalidVertexId;
+}
+
+//Each letter becomes a base-26 digit, and any other code maps past the end of the table
+//The subtractions wrap around for characters below 'A', so a single comparison per letter rejects them
+size_t FlightGraph::getIataIndex(AirportCode airportCode) {
+    std::uint32_t value = airportCode.getValue();
+    std::uint32_t first = (value >> 24) - 'A';
+    std::uint32_t second = ((value >> 16) & 0xFF) - 'A';
+    std::uint32_t third = ((value >> 8) & 0xFF) - 'A';
+    if ((value & 0xFF) != 0 || first >= 26 || second >= 26 || third >= 26) {
+        return iataTableSize;
+    }
+    return (first * 26 + second) * 26 + third;
+}
+
+void FlightGraph::buildIataTable() {
+    iataVertexIds.assign(iataTableSize, invalidVertexId);
+    for (VertexId vertex = 0; vertex < airportCodes.size(); ++vertex) {
+        size_t index = getIataIndex(airportCodes.at(vertex));
+        if (index < iataTableSize) {
+            iataVertexIds.at(index) = vertex;
+        }
+    }
+}
+
+const std::string& FlightGraph::getAirportCode(VertexId vertex) const {
+    return airportCodeList.at(vertex);
+}
+
+std::uint64_t FlightGraph::getGraphChecksum() const {
+    std::uint64_t hash = computeChecksum(nullptr, 0);
+    for (VertexId vertex = 0; vertex < getVertexCount(); ++vertex) {
+        const std::string& code = airportCodeList.at(vertex);
+        hash = computeChecksum(code.data(), code.size(), hash);
+        hash = computeChecksum(",", 1, hash); //Separates the codes, so that a different split of the same characters changes the hash
+        NeighborRange range = neighbors(vertex);
+        hash = computeChecksum(reinterpret_cast<const char*>(range.targets), range.count * sizeof(VertexId), hash);
+        hash = computeChecksum(reinterpret_cast<const char*>(range.weights), range.count * sizeof(double), hash); //Weights depend on the airport coordinates, not only on the routes
+    }
+    return hash;
+}
+
+//The central angle between two unit vectors is the acos of their dot product, which is the same great-circle distance that the edge weights use
+//Every edge weight is the great-circle distance between its airports, so by the triangle inequality no path is shorter than this bound
+//The bound is lowered by a meter to absorb the rounding differences between acos and the haversine formula, which keeps it admissible
+double FlightGraph::getGreatCircleLowerBound(VertexId origin, VertexId destination) const {
+    const double* originVector = unitSphereVectors.data() + 3 * (size_t) origin;
+    const double* destinationVector = unitSphereVectors.data() + 3 * (size_t) destination;
+    double dotProduct = originVector[0] * destinationVector[0] + originVector[1] * destinationVector[1] + originVector[2] * destinationVector[2];
+    double bound = radiusOfEarth * std::acos(std::min(1.0, std::max(-1.0, dotProduct))) - 0.001;
+    return bound > 0.0 ? bound : 0.0;
+}
+
+FlightGraph::NeighborRange FlightGraph::neighbors(VertexId vertex) const {
+    size_t first = adjacencyOffsets[vertex];
+    return NeighborRange {adjacencyTargets.data() + first, adjacencyWeights.data() + first, adjacencyOffsets[vertex + 1] - first};
+}
+
+FlightGraph::NeighborRange FlightGraph::reverseNeighbors(VertexId vertex) const {
+    size_t first = reverseAdjacencyOffsets[vertex];
+    return NeighborRange {reverseAdjacencyTargets.data() + first, reverseAdjacencyWeights.data() + first, reverseAdjacencyOffsets[vertex + 1] - first};
+}
+
+//Binary search since each CSR row is sorted
+bool FlightGraph::areAdjacent(VertexId origin, VertexId destination) const {
+    const NeighborRange& incident = neighbors(origin);
+    return std::binary_search(incident.begin(), incident.end(), destination);
+}
+
+std::vector<std::vector<FlightGraph::VertexId>> FlightGraph::breadthFirstSearch(VertexId root) const {
+    BreadthFirstSearchState state;
+    initializeBreadthFirstSearch(state);
+
+    std::vector<std::vector<VertexId>> bfs;
+
+    bfs.push_back(std::vector<VertexId>());
+    breadthFirstSearch(root, state, bfs.back());
+
+    for (VertexId vertex = 0; vertex < airportCodeList.size(); ++vertex) {
+        if (!(state.visited[vertex / 64] >> (vertex % 64) & 1)) {
+            bfs.push_back(std::vector<VertexId>()); //Insert traversal of new component into bfs
+            breadthFirstSearch(vertex, state, bfs.back());
+        }
+    }
+
+    return bfs;
+}
+
+//Plain top-down search, so a call costs O(component) rather than the O(V) setup of a direction-optimizing search (callers loop over the components with it)
+std::vector<FlightGraph::VertexId> FlightGraph::breadthFirstSearch(VertexId root, std::vector<bool>& visited) const {
+    std::vector<VertexId> traversal;
+
+    std::queue<VertexId> queue;
+    visited.at(root) = true;
+
+    queue.push(root);
     while (!queue.empty()) {
-        const std::string front = queue.front();
+        VertexId front = queue.front();
         traversal.push_back(front);
         queue.pop();
-        const std::vector<std::string>& incident = getIncidentAirportCodes(front);
-        for (const std::string& i : incident) {
-            if (!visited.at(airportCodeMap.at(i))) {
-                visited.at(airportCodeMap.at(i)) = true;
-                queue.push(i);
+        for (VertexId target : neighbors(front)) { //Contiguous scan of the CSR row
+            if (!visited[target]) {
+                visited[target] = true;
+                queue.push(target);
             }
         }
     }
@@ -146,57 +653,974 @@ std::vector<std::string> FlightGraph::breadthFirstSearch(const std::string& airp
     return traversal;
 }
 
-//(https://www.geeksforgeeks.org/dijkstras-shortest-path-algorithm-using-set-in-stl/)
-std::vector<std::string> FlightGraph::findShortestPath(const std::string& originAirportCode, const std::string& destinationAirportCode) {
-    std::vector<double> distance = std::vector<double>(airportCodeList.size(), std::numeric_limits<double>::max());
-    std::vector<std::string> predecessor = std::vector<std::string>(airportCodeList.size(), "");
-    distance.at(airportCodeMap.at(originAirportCode)) = 0;
+std::vector<std::vector<std::string>> FlightGraph::breadthFirstSearch(const std::string& rootAirportCode, ThreadPool& pool) const {
+    const std::vector<std::vector<VertexId>>& components = breadthFirstSearch(getVertexId(rootAirportCode), pool);
 
-    std::set<std::pair<double, std::string>> minDistanceSet;
-    for (size_t i = 0; i < airportCodeList.size(); ++i) {
-        minDistanceSet.insert(std::pair<double, std::string>(distance.at(i), airportCodeList.at(i)));
+    std::vector<std::vector<std::string>> bfs;
+    bfs.reserve(components.size());
+    for (const std::vector<VertexId>& component : components) {
+        std::vector<std::string> traversal;
+        traversal.reserve(component.size());
+        for (VertexId vertex : component) {
+            traversal.push_back(airportCodeList.at(vertex));
+        }
+        bfs.push_back(traversal);
+    }
+    return bfs;
+}
+
+std::vector<std::vector<FlightGraph::VertexId>> FlightGraph::breadthFirstSearch(VertexId root, ThreadPool& pool) const {
+    size_t vertexCount = airportCodeList.size();
+    size_t wordCount = (vertexCount + 63) / 64;
+    ParallelBreadthFirstSearchState state;
+    state.visited.reset(new std::atomic<std::uint64_t>[wordCount]);
+    state.parentPositions.reset(new std::atomic<VertexId>[vertexCount]);
+    for (size_t word = 0; word < wordCount; ++word) {
+        state.visited[word].store(0, std::memory_order_relaxed);
+    }
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+        state.parentPositions[vertex].store(invalidVertexId, std::memory_order_relaxed);
+    }
+    state.frontier.assign(wordCount, 0);
+    state.frontierPositions.assign(vertexCount, 0);
+    state.unvisitedEdgeCount = reverseAdjacencyTargets.size();
+
+    std::vector<std::vector<VertexId>> bfs;
+
+    bfs.push_back(std::vector<VertexId>());
+    breadthFirstSearch(root, state, pool, bfs.back());
+
+    for (VertexId vertex = 0; vertex < vertexCount; ++vertex) {
+        if (!(state.visited[vertex / 64].load(std::memory_order_relaxed) >> (vertex % 64) & 1)) {
+            bfs.push_back(std::vector<VertexId>()); //Insert traversal of new component into bfs
+            breadthFirstSearch(vertex, state, pool, bfs.back());
+        }
     }
 
-    std::set<std::string> visitedAirportSet;
+    return bfs;
+}
+
+//Levels switch between top-down and bottom-up steps like the serial search, and each step is split into chunks that run as tasks on the pool (the pool's run is the barrier between phases)
+//Top-down steps split the frontier into chunks of consecutive vertices and run two phases
+//1. Every frontier vertex lowers the parent position of its unvisited targets to its own position with an atomic minimum (visited bits are read-only in this phase)
+//2. Every frontier vertex appends the unvisited targets whose parent position is its own, in CSR order, to its chunk's part of the next level, so the parts in chunk order are the next level
+//Bottom-up steps split the vertex IDs into chunks, and each chunk finds the smallest frontier position among the incoming edges of its unvisited vertices (as in expandBottomUp)
+//The parts are then ordered by parent position with a counting sort, which is stable, so vertices with the same parent stay in ID order
+//Either way the next level is exactly the order of a FIFO queue, no matter how the tasks are scheduled
+//A vertex whose parent position is set becomes visited in the same level, so parent positions never need to be reset
+//Steps with few edges to scan run on the calling thread, since a pool batch costs more than expanding them
+void FlightGraph::breadthFirstSearch(VertexId root, ParallelBreadthFirstSearchState& state, ThreadPool& pool, std::vector<VertexId>& traversal) const {
+    static constexpr size_t chunkSize = 256; //Frontier vertices per top-down task
+    static constexpr size_t chunkWordCount = 64; //Bitmap words (64 vertices each) per bottom-up task
+    static constexpr size_t minParallelEdgeCount = 16384; //Edges to scan below which a step runs serially
+    size_t vertexCount = airportCodeList.size();
+    size_t wordCount = (vertexCount + 63) / 64;
+
+    auto isVisited = [&](VertexId vertex) { return state.visited[vertex / 64].load(std::memory_order_relaxed) >> (vertex % 64) & 1; };
+    size_t levelBegin = traversal.size();
+    if (!isVisited(root)) {
+        state.visited[root / 64].fetch_or(std::uint64_t(1) << (root % 64), std::memory_order_relaxed);
+        state.unvisitedEdgeCount -= reverseNeighbors(root).size();
+    }
+    traversal.push_back(root);
+    size_t frontierEdgeCount = neighbors(root).size();
+    bool isBottomUp = false;
+
+    while (levelBegin < traversal.size()) {
+        size_t levelEnd = traversal.size();
+        size_t levelSize = levelEnd - levelBegin;
+        if (!isBottomUp && frontierEdgeCount > state.unvisitedEdgeCount) {
+            isBottomUp = true;
+        } else if (isBottomUp && levelSize * 24 < vertexCount) {
+            isBottomUp = false;
+        }
+
+        size_t chunkCount = 0;
+        if (isBottomUp) {
+            for (size_t i = levelBegin; i < levelEnd; ++i) {
+                VertexId vertex = traversal[i];
+                state.frontier[vertex / 64] |= std::uint64_t(1) << (vertex % 64);
+                state.frontierPositions[vertex] = (VertexId) (i - levelBegin);
+            }
+            chunkCount = (wordCount + chunkWordCount - 1) / chunkWordCount;
+            if (state.chunkLevels.size() < chunkCount) {
+                state.chunkLevels.resize(chunkCount);
+            }
+            runChunks(pool, chunkCount, state.unvisitedEdgeCount >= minParallelEdgeCount, [&](size_t chunk) {
+                std::vector<VertexId>& children = state.chunkLevels[chunk];
+                children.clear();
+                for (size_t word = chunk * chunkWordCount; word < std::min(wordCount, (chunk + 1) * chunkWordCount); ++word) {
+                    std::uint64_t unvisited = ~state.visited[word].load(std::memory_order_relaxed);
+                    while (unvisited != 0) {
+                        VertexId vertex = (VertexId) (word * 64 + __builtin_ctzll(unvisited));
+                        unvisited &= unvisited - 1;
+                        if (vertex >= vertexCount) {
+                            break;
+                        }
+                        VertexId parentPosition = invalidVertexId;
+                        for (VertexId source : reverseNeighbors(vertex)) {
+                            if ((state.frontier[source / 64] >> (source % 64) & 1) && state.frontierPositions[source] < parentPosition) {
+                                parentPosition = state.frontierPositions[source];
+                            }
+                        }
+                        if (parentPosition != invalidVertexId) {
+                            state.parentPositions[vertex].store(parentPosition, std::memory_order_relaxed);
+                            children.push_back(vertex);
+                        }
+                    }
+                }
+            });
+            for (size_t i = levelBegin; i < levelEnd; ++i) {
+                VertexId vertex = traversal[i];
+                state.frontier[vertex / 64] &= ~(std::uint64_t(1) << (vertex % 64));
+            }
+
+            //Counting sort by parent position (the parts are in ID order)
+            state.positionCounts.assign(levelSize + 1, 0);
+            for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+                for (VertexId vertex : state.chunkLevels[chunk]) {
+                    ++state.positionCounts[state.parentPositions[vertex].load(std::memory_order_relaxed) + 1];
+                }
+            }
+            for (size_t i = 1; i < state.positionCounts.size(); ++i) {
+                state.positionCounts[i] += state.positionCounts[i - 1];
+            }
+            traversal.resize(levelEnd + state.positionCounts.back());
+            for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+                for (VertexId vertex : state.chunkLevels[chunk]) {
+                    traversal[levelEnd + state.positionCounts[state.parentPositions[vertex].load(std::memory_order_relaxed)]++] = vertex;
+                }
+            }
+        } else {
+            bool isParallel = frontierEdgeCount >= minParallelEdgeCount;
+            chunkCount = isParallel ? (levelSize + chunkSize - 1) / chunkSize : 1;
+            if (state.chunkLevels.size() < chunkCount) {
+                state.chunkLevels.resize(chunkCount);
+            }
+            auto getChunkBegin = [&](size_t chunk) { return levelBegin + levelSize * chunk / chunkCount; };
+            runChunks(pool, chunkCount, isParallel, [&](size_t chunk) {
+                for (size_t i = getChunkBegin(chunk); i < getChunkBegin(chunk + 1); ++i) {
+                    VertexId position = (VertexId) (i - levelBegin);
+                    for (VertexId target : neighbors(traversal[i])) {
+                        if (!isVisited(target)) {
+                            VertexId current = state.parentPositions[target].load(std::memory_order_relaxed);
+                            while (position < current && !state.parentPositions[target].compare_exchange_weak(current, position, std::memory_order_relaxed)) {
+                            }
+                        }
+                    }
+                }
+            });
+            runChunks(pool, chunkCount, isParallel, [&](size_t chunk) {
+                std::vector<VertexId>& children = state.chunkLevels[chunk];
+                children.clear();
+                for (size_t i = getChunkBegin(chunk); i < getChunkBegin(chunk + 1); ++i) {
+                    VertexId position = (VertexId) (i - levelBegin);
+                    for (VertexId target : neighbors(traversal[i])) {
+                        if (!isVisited(target) && state.parentPositions[target].load(std::memory_order_relaxed) == position) {
+                            children.push_back(target);
+                        }
+                    }
+                }
+            });
 
-    while (!minDistanceSet.empty()) {
-        const std::string minVertex = minDistanceSet.begin()->second;
-        minDistanceSet.erase(minDistanceSet.begin());
-        visitedAirportSet.insert(minVertex);
-        const std::vector<std::string>& incident = getIncidentAirportCodes(minVertex);
-        for (const std::string& code : incident) {
-            if (visitedAirportSet.count(code) == 0 && adjacencyMatrix.at(airportCodeMap.at(minVertex)).at(airportCodeMap.at(code)) + distance.at(airportCodeMap.at(minVertex)) < distance.at(airportCodeMap.at(code))) {
-                minDistanceSet.erase(minDistanceSet.find(std::pair<double, std::string>(distance.at(airportCodeMap.at(code)), code)));
-                distance.at(airportCodeMap.at(code)) = adjacencyMatrix.at(airportCodeMap.at(minVertex)).at(airportCodeMap.at(code)) + distance.at(airportCodeMap.at(minVertex));
-                predecessor.at(airportCodeMap.at(code)) = minVertex;
-                minDistanceSet.insert(std::pair<double, std::string>(distance.at(airportCodeMap.at(code)), code));
+            state.chunkOffsets.assign(chunkCount + 1, levelEnd);
+            for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+                state.chunkOffsets[chunk + 1] = state.chunkOffsets[chunk] + state.chunkLevels[chunk].size();
             }
+            traversal.resize(state.chunkOffsets[chunkCount]);
+            runChunks(pool, chunkCount, isParallel, [&](size_t chunk) {
+                std::copy(state.chunkLevels[chunk].begin(), state.chunkLevels[chunk].end(), traversal.begin() + state.chunkOffsets[chunk]);
+            });
         }
+
+        //Marks the next level as visited
+        frontierEdgeCount = 0;
+        for (size_t i = levelEnd; i < traversal.size(); ++i) {
+            VertexId vertex = traversal[i];
+            state.visited[vertex / 64].fetch_or(std::uint64_t(1) << (vertex % 64), std::memory_order_relaxed);
+            state.unvisitedEdgeCount -= reverseNeighbors(vertex).size();
+            frontierEdgeCount += neighbors(vertex).size();
+        }
+        levelBegin = levelEnd;
     }
+}
 
-    std::vector<std::string> shortestPath {destinationAirportCode};
-    if (predecessor.at(airportCodeMap.at(destinationAirportCode)).compare("") == 0) {
-        return shortestPath;
+FlightGraph::ComponentLabels FlightGraph::components() const {
+    std::unique_ptr<std::atomic<VertexId>[]> parents(new std::atomic<VertexId>[airportCodeList.size()]);
+    for (VertexId vertex = 0; vertex < airportCodeList.size(); ++vertex) {
+        parents[vertex].store(vertex, std::memory_order_relaxed);
     }
-    std::string currentCode = destinationAirportCode;
-    while (currentCode != originAirportCode) {
-        currentCode = predecessor.at(airportCodeMap.at(currentCode));
-        shortestPath.push_back(currentCode);
+    uniteComponents(0, (VertexId) airportCodeList.size(), parents.get());
+    return labelComponents(parents.get());
+}
+
+FlightGraph::ComponentLabels FlightGraph::components(ThreadPool& pool) const {
+    static constexpr size_t chunkEdgeCount = 65536; //Edges per task (rounded to whole rows)
+    std::unique_ptr<std::atomic<VertexId>[]> parents(new std::atomic<VertexId>[airportCodeList.size()]);
+    for (VertexId vertex = 0; vertex < airportCodeList.size(); ++vertex) {
+        parents[vertex].store(vertex, std::memory_order_relaxed);
+    }
+
+    //Splits the rows into chunks of about chunkEdgeCount edges, so that airports with many routes do not unbalance the tasks
+    std::vector<VertexId> chunkBegins {0};
+    for (VertexId vertex = 0; vertex < airportCodeList.size(); ++vertex) {
+        if (adjacencyOffsets[vertex + 1] - adjacencyOffsets[chunkBegins.back()] >= chunkEdgeCount) {
+            chunkBegins.push_back(vertex + 1);
+        }
+    }
+    if (chunkBegins.back() != airportCodeList.size()) {
+        chunkBegins.push_back((VertexId) airportCodeList.size());
+    }
+    pool.run(chunkBegins.size() - 1, [&](size_t chunk, size_t) {
+        uniteComponents(chunkBegins.at(chunk), chunkBegins.at(chunk + 1), parents.get());
+    });
+    return labelComponents(parents.get());
+}
+
+void FlightGraph::uniteComponents(VertexId first, VertexId last, std::atomic<VertexId>* parents) const {
+    for (VertexId vertex = first; vertex < last; ++vertex) {
+        for (VertexId target : neighbors(vertex)) {
+            VertexId a = vertex;
+            VertexId b = target;
+            while (true) {
+                a = findComponentRoot(parents, a);
+                b = findComponentRoot(parents, b);
+                if (a == b) {
+                    break;
+                }
+                if (a < b) {
+                    std::swap(a, b);
+                }
+                VertexId expected = a;
+                if (parents[a].compare_exchange_strong(expected, b, std::memory_order_relaxed)) { //Links the larger root below the smaller one
+                    break;
+                }
+            }
+        }
+    }
+}
+
+//Roots are the smallest vertices of their sets, so numbering the roots in ID order numbers the components in order of their smallest vertex
+//A vertex's root is found before any larger vertex's, so it is already numbered when the vertex is reached
+FlightGraph::ComponentLabels FlightGraph::labelComponents(std::atomic<VertexId>* parents) const {
+    ComponentLabels labels;
+    labels.componentIds.resize(airportCodeList.size());
+    for (VertexId vertex = 0; vertex < airportCodeList.size(); ++vertex) {
+        VertexId root = findComponentRoot(parents, vertex);
+        if (root == vertex) {
+            labels.componentIds[vertex] = (VertexId) labels.componentSizes.size();
+            labels.componentSizes.push_back(0);
+        } else {
+            labels.componentIds[vertex] = labels.componentIds[root];
+        }
+        ++labels.componentSizes[labels.componentIds[vertex]];
+    }
+    return labels;
+}
+
+//Each iteration of the loop either follows the next outgoing edge of the vertex on top of the call stack or finishes that vertex, so the call stack replaces the recursion of the textbook algorithm
+FlightGraph::ComponentLabels FlightGraph::stronglyConnectedComponents() const {
+    size_t vertexCount = airportCodeList.size();
+    std::vector<VertexId> indices(vertexCount, invalidVertexId); //Order in which the vertices were reached
+    std::vector<VertexId> lowLinks(vertexCount, 0); //Smallest index reachable from the vertex's subtree through vertices on the stack
+    std::vector<bool> isOnStack(vertexCount, false);
+    std::vector<VertexId> stack; //Vertices whose component is not finished yet
+    std::vector<std::pair<VertexId, size_t>> callStack; //(vertex, position of its next outgoing edge)
+    std::vector<VertexId> representatives(vertexCount);
+    VertexId nextIndex = 0;
+
+    for (VertexId start = 0; start < vertexCount; ++start) {
+        if (indices[start] != invalidVertexId) {
+            continue;
+        }
+        indices[start] = lowLinks[start] = nextIndex++;
+        stack.push_back(start);
+        isOnStack[start] = true;
+        callStack.push_back(std::make_pair(start, adjacencyOffsets[start]));
+
+        while (!callStack.empty()) {
+            VertexId vertex = callStack.back().first;
+            size_t& position = callStack.back().second;
+            if (position < adjacencyOffsets[vertex + 1]) {
+                VertexId target = adjacencyTargets[position++];
+                if (indices[target] == invalidVertexId) { //Tree edge (position may be invalidated by the push)
+                    indices[target] = lowLinks[target] = nextIndex++;
+                    stack.push_back(target);
+                    isOnStack[target] = true;
+                    callStack.push_back(std::make_pair(target, adjacencyOffsets[target]));
+                } else if (isOnStack[target]) {
+                    lowLinks[vertex] = std::min(lowLinks[vertex], indices[target]);
+                }
+                continue;
+            }
+
+            callStack.pop_back();
+            if (lowLinks[vertex] == indices[vertex]) { //vertex is the root of a component, which is the top of the stack down to vertex
+                VertexId member = invalidVertexId;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    isOnStack[member] = false;
+                    representatives[member] = vertex;
+                } while (member != vertex);
+            }
+            if (!callStack.empty()) {
+                VertexId parent = callStack.back().first;
+                lowLinks[parent] = std::min(lowLinks[parent], lowLinks[vertex]);
+            }
+        }
+    }
+
+    return labelByRepresentative(representatives);
+}
+
+//Trimming: a vertex without incoming or outgoing edges from the remaining vertices is a component by itself, and removing it may trim its neighbors (degrees are decremented atomically, and a vertex is claimed by whichever thread trims it)
+//Forward-backward: in a partition, the vertices that the pivot reaches and that reach the pivot form the pivot's component, and every other component lies entirely in one of the three remaining parts (reached only, reaching only, or neither), which become new partitions
+//Partitions are disjoint, so each round searches all of them at once - large partitions one at a time with parallel searches, and small partitions as one task each
+//A partition's label is its smallest vertex, which is also its pivot, so labels stay unique without coordination (a vertex with a finished component has label invalidVertexId)
+FlightGraph::ComponentLabels FlightGraph::stronglyConnectedComponents(ThreadPool& pool) const {
+    static constexpr size_t chunkSize = 4096; //Vertices per task when a pass over vertices is split
+    static constexpr size_t minParallelPartitionSize = 65536; //Partitions below this size are searched by a single task
+    size_t vertexCount = airportCodeList.size();
+    size_t chunkCount = (vertexCount + chunkSize - 1) / chunkSize;
+    bool isParallel = chunkCount > 1;
+    auto getChunkBegin = [&](size_t chunk, size_t count) { return count * chunk / chunkCount; };
+
+    std::unique_ptr<std::atomic<VertexId>[]> partitions(new std::atomic<VertexId>[vertexCount]);
+    std::unique_ptr<std::atomic<std::uint8_t>[]> marks(new std::atomic<std::uint8_t>[vertexCount]); //Bit 0 is set if the pivot reaches the vertex, and bit 1 if the vertex reaches the pivot
+    std::unique_ptr<std::atomic<VertexId>[]> inDegrees(new std::atomic<VertexId>[vertexCount]);
+    std::unique_ptr<std::atomic<VertexId>[]> outDegrees(new std::atomic<VertexId>[vertexCount]);
+    std::vector<VertexId> representatives(vertexCount);
+    std::vector<std::vector<VertexId>> chunkVertices(chunkCount);
+
+    //Trims vertices in rounds until none is left to trim
+    std::vector<VertexId> trimmed;
+    runChunks(pool, chunkCount, isParallel, [&](size_t chunk) {
+        chunkVertices[chunk].clear();
+        for (VertexId vertex = (VertexId) getChunkBegin(chunk, vertexCount); vertex < getChunkBegin(chunk + 1, vertexCount); ++vertex) {
+            partitions[vertex].store(0, std::memory_order_relaxed);
+            marks[vertex].store(0, std::memory_order_relaxed);
+            inDegrees[vertex].store((VertexId) reverseNeighbors(vertex).size(), std::memory_order_relaxed);
+            outDegrees[vertex].store((VertexId) neighbors(vertex).size(), std::memory_order_relaxed);
+            if (reverseNeighbors(vertex).size() == 0 || neighbors(vertex).size() == 0) {
+                partitions[vertex].store(invalidVertexId, std::memory_order_relaxed);
+                chunkVertices[chunk].push_back(vertex);
+            }
+        }
+    });
+    for (const std::vector<VertexId>& vertices : chunkVertices) {
+        trimmed.insert(trimmed.end(), vertices.begin(), vertices.end());
+    }
+    while (!trimmed.empty()) {
+        size_t trimmedCount = trimmed.size();
+        runChunks(pool, chunkCount, isParallel && trimmedCount >= chunkSize, [&](size_t chunk) {
+            chunkVertices[chunk].clear();
+            for (size_t i = getChunkBegin(chunk, trimmedCount); i < getChunkBegin(chunk + 1, trimmedCount); ++i) {
+                VertexId vertex = trimmed[i];
+                representatives[vertex] = vertex;
+                for (VertexId target : neighbors(vertex)) {
+                    VertexId expected = 0;
+                    if (inDegrees[target].fetch_sub(1, std::memory_order_relaxed) == 1 && partitions[target].compare_exchange_strong(expected, invalidVertexId, std::memory_order_relaxed)) {
+                        chunkVertices[chunk].push_back(target);
+                    }
+                }
+                for (VertexId source : reverseNeighbors(vertex)) {
+                    VertexId expected = 0;
+                    if (outDegrees[source].fetch_sub(1, std::memory_order_relaxed) == 1 && partitions[source].compare_exchange_strong(expected, invalidVertexId, std::memory_order_relaxed)) {
+                        chunkVertices[chunk].push_back(source);
+                    }
+                }
+            }
+        });
+        trimmed.clear();
+        for (const std::vector<VertexId>& vertices : chunkVertices) {
+            trimmed.insert(trimmed.end(), vertices.begin(), vertices.end());
+        }
+    }
+
+    //The remaining vertices form the first partition, whose label is its smallest vertex
+    std::vector<VertexId> remaining;
+    for (VertexId vertex = 0; vertex < vertexCount; ++vertex) {
+        if (partitions[vertex].load(std::memory_order_relaxed) == 0) {
+            remaining.push_back(vertex);
+        }
+    }
+    std::vector<std::vector<VertexId>> currentPartitions;
+    if (!remaining.empty()) {
+        for (VertexId vertex : remaining) {
+            partitions[vertex].store(remaining.front(), std::memory_order_relaxed);
+        }
+        currentPartitions.push_back(std::move(remaining));
+    }
+
+    //Splits a searched partition into the pivot's component and the three remaining parts (in ID order, so each part's label is its first vertex)
+    auto splitPartition = [&](const std::vector<VertexId>& members, std::vector<std::vector<VertexId>>& parts) {
+        VertexId pivot = members.front();
+        parts.assign(3, std::vector<VertexId>());
+        for (VertexId vertex : members) {
+            std::uint8_t mark = marks[vertex].load(std::memory_order_relaxed);
+            marks[vertex].store(0, std::memory_order_relaxed);
+            if (mark == 3) {
+                representatives[vertex] = pivot;
+                partitions[vertex].store(invalidVertexId, std::memory_order_relaxed);
+            } else {
+                parts[mark].push_back(vertex);
+            }
+        }
+        for (const std::vector<VertexId>& part : parts) {
+            for (VertexId vertex : part) {
+                partitions[vertex].store(part.front(), std::memory_order_relaxed);
+            }
+        }
+    };
+
+    while (!currentPartitions.empty()) {
+        std::vector<std::vector<std::vector<VertexId>>> partitionParts(currentPartitions.size());
+        std::vector<size_t> smallPartitions;
+        for (size_t i = 0; i < currentPartitions.size(); ++i) {
+            const std::vector<VertexId>& members = currentPartitions[i];
+            if (members.size() < minParallelPartitionSize) {
+                smallPartitions.push_back(i);
+                continue;
+            }
+            markReachable(members.front(), members.front(), false, 1, partitions.get(), marks.get(), pool);
+            markReachable(members.front(), members.front(), true, 2, partitions.get(), marks.get(), pool);
+            splitPartition(members, partitionParts[i]);
+        }
+        pool.run(smallPartitions.size(), [&](size_t task, size_t) {
+            size_t i = smallPartitions[task];
+            const std::vector<VertexId>& members = currentPartitions[i];
+            VertexId pivot = members.front();
+            if (members.size() == 1) {
+                representatives[pivot] = pivot;
+                partitions[pivot].store(invalidVertexId, std::memory_order_relaxed);
+                return;
+            }
+            //Serial searches, since the partition belongs to this task alone
+            std::vector<VertexId> queue;
+            for (std::uint8_t mark : {std::uint8_t(1), std::uint8_t(2)}) {
+                queue.assign(1, pivot);
+                marks[pivot].store(marks[pivot].load(std::memory_order_relaxed) | mark, std::memory_order_relaxed);
+                for (size_t j = 0; j < queue.size(); ++j) {
+                    for (VertexId target : (mark == 1 ? neighbors(queue[j]) : reverseNeighbors(queue[j]))) {
+                        std::uint8_t targetMark = marks[target].load(std::memory_order_relaxed);
+                        if (partitions[target].load(std::memory_order_relaxed) == pivot && !(targetMark & mark)) {
+                            marks[target].store(targetMark | mark, std::memory_order_relaxed);
+                            queue.push_back(target);
+                        }
+                    }
+                }
+            }
+            splitPartition(members, partitionParts[i]);
+        });
+
+        std::vector<std::vector<VertexId>> nextPartitions;
+        for (std::vector<std::vector<VertexId>>& parts : partitionParts) {
+            for (std::vector<VertexId>& part : parts) {
+                if (!part.empty()) {
+                    nextPartitions.push_back(std::move(part));
+                }
+            }
+        }
+        currentPartitions.swap(nextPartitions);
+    }
+
+    return labelByRepresentative(representatives);
+}
+
+//Level-synchronous search whose levels are split into tasks when they are large, where each vertex is claimed by the thread whose atomic OR sets its mark first
+void FlightGraph::markReachable(VertexId pivot, VertexId partition, bool reverse, std::uint8_t mark, std::atomic<VertexId>* partitions, std::atomic<std::uint8_t>* marks, ThreadPool& pool) const {
+    static constexpr size_t chunkSize = 256; //Frontier vertices per task
+    static constexpr size_t minParallelLevelSize = 4096; //Levels below this size are expanded on the calling thread
+    std::vector<VertexId> level {pivot};
+    marks[pivot].fetch_or(mark, std::memory_order_relaxed);
+    std::vector<std::vector<VertexId>> chunkLevels;
+
+    while (!level.empty()) {
+        size_t chunkCount = (level.size() + chunkSize - 1) / chunkSize;
+        chunkLevels.resize(std::max(chunkLevels.size(), chunkCount));
+        runChunks(pool, chunkCount, level.size() >= minParallelLevelSize, [&](size_t chunk) {
+            std::vector<VertexId>& nextLevel = chunkLevels[chunk];
+            nextLevel.clear();
+            for (size_t i = chunk * chunkSize; i < std::min(level.size(), (chunk + 1) * chunkSize); ++i) {
+                for (VertexId target : (reverse ? reverseNeighbors(level[i]) : neighbors(level[i]))) {
+                    if (partitions[target].load(std::memory_order_relaxed) == partition && !(marks[target].load(std::memory_order_relaxed) & mark) && !(marks[target].fetch_or(mark, std::memory_order_relaxed) & mark)) {
+                        nextLevel.push_back(target);
+                    }
+                }
+            }
+        });
+        level.clear();
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            level.insert(level.end(), chunkLevels[chunk].begin(), chunkLevels[chunk].end());
+        }
+    }
+}
+
+FlightGraph::ComponentLabels FlightGraph::labelByRepresentative(const std::vector<VertexId>& representatives) {
+    ComponentLabels labels;
+    labels.componentIds.resize(representatives.size());
+    std::vector<VertexId> representativeIds(representatives.size(), invalidVertexId);
+    for (VertexId vertex = 0; vertex < representatives.size(); ++vertex) {
+        VertexId& id = representativeIds[representatives[vertex]];
+        if (id == invalidVertexId) {
+            id = (VertexId) labels.componentSizes.size();
+            labels.componentSizes.push_back(0);
+        }
+        labels.componentIds[vertex] = id;
+        ++labels.componentSizes[id];
+    }
+    return labels;
+}
+
+void FlightGraph::initializeBreadthFirstSearch(BreadthFirstSearchState& state) const {
+    size_t wordCount = (airportCodeList.size() + 63) / 64;
+    state.visited.assign(wordCount, 0);
+    state.frontier.assign(wordCount, 0);
+    state.frontierPositions.assign(airportCodeList.size(), 0);
+    state.unvisitedEdgeCount = reverseAdjacencyTargets.size(); //Every incoming edge belongs to an unvisited vertex
+}
+
+//The traversal itself is the queue - each level is a contiguous range of it
+//Top-down steps scan the outgoing edges of the frontier in order, exactly like a FIFO queue
+//Bottom-up steps scan every incoming edge of the unvisited vertices (see expandBottomUp), so they are used once the frontier has more outgoing edges than that, and until the frontier becomes small again (beta = 24, as suggested by Beamer et al.)
+//Beamer et al. switch much earlier (alpha = 14) because their bottom-up steps stop at the first parent found, which would not preserve the FIFO order
+void FlightGraph::breadthFirstSearch(VertexId root, BreadthFirstSearchState& state, std::vector<VertexId>& traversal) const {
+    size_t vertexCount = airportCodeList.size();
+    size_t levelBegin = traversal.size();
+    if (!(state.visited[root / 64] >> (root % 64) & 1)) {
+        state.visited[root / 64] |= std::uint64_t(1) << (root % 64);
+        state.unvisitedEdgeCount -= reverseNeighbors(root).size();
+    }
+    traversal.push_back(root);
+    size_t frontierEdgeCount = neighbors(root).size();
+    bool isBottomUp = false;
+
+    while (levelBegin < traversal.size()) {
+        size_t levelEnd = traversal.size();
+        if (!isBottomUp && frontierEdgeCount > state.unvisitedEdgeCount) {
+            isBottomUp = true;
+        } else if (isBottomUp && (levelEnd - levelBegin) * 24 < vertexCount) {
+            isBottomUp = false;
+        }
+
+        if (isBottomUp) {
+            expandBottomUp(state, traversal, levelBegin, levelEnd);
+        } else {
+            for (size_t i = levelBegin; i < levelEnd; ++i) {
+                for (VertexId target : neighbors(traversal[i])) { //Contiguous scan of the CSR row
+                    if (!(state.visited[target / 64] >> (target % 64) & 1)) {
+                        state.visited[target / 64] |= std::uint64_t(1) << (target % 64);
+                        state.unvisitedEdgeCount -= reverseNeighbors(target).size();
+                        traversal.push_back(target);
+                    }
+                }
+            }
+        }
+
+        frontierEdgeCount = 0;
+        for (size_t i = levelEnd; i < traversal.size(); ++i) {
+            frontierEdgeCount += neighbors(traversal[i]).size();
+        }
+        levelBegin = levelEnd;
+    }
+}
+
+//A FIFO queue appends a vertex when its first parent in the frontier is dequeued, and a parent's targets in CSR order (by vertex ID)
+//Therefore the next level is ordered by (position of the first parent in the frontier, vertex ID) - unvisited vertices are scanned by ID, so a counting sort by parent position gives that order
+//Every incoming edge of an unvisited vertex is checked, since the first parent is the one with the smallest position rather than the first one found
+void FlightGraph::expandBottomUp(BreadthFirstSearchState& state, std::vector<VertexId>& traversal, size_t levelBegin, size_t levelEnd) const {
+    size_t vertexCount = airportCodeList.size();
+    for (size_t i = levelBegin; i < levelEnd; ++i) {
+        VertexId vertex = traversal[i];
+        state.frontier[vertex / 64] |= std::uint64_t(1) << (vertex % 64);
+        state.frontierPositions[vertex] = (VertexId) (i - levelBegin);
+    }
+
+    state.discovered.clear();
+    for (size_t word = 0; word < state.visited.size(); ++word) {
+        std::uint64_t unvisited = ~state.visited[word];
+        while (unvisited != 0) {
+            VertexId vertex = (VertexId) (word * 64 + __builtin_ctzll(unvisited));
+            unvisited &= unvisited - 1;
+            if (vertex >= vertexCount) {
+                break;
+            }
+            VertexId parentPosition = invalidVertexId;
+            for (VertexId source : reverseNeighbors(vertex)) {
+                if ((state.frontier[source / 64] >> (source % 64) & 1) && state.frontierPositions[source] < parentPosition) {
+                    parentPosition = state.frontierPositions[source];
+                }
+            }
+            if (parentPosition != invalidVertexId) {
+                state.discovered.push_back(std::make_pair(parentPosition, vertex));
+            }
+        }
+    }
+
+    state.positionCounts.assign(levelEnd - levelBegin + 1, 0);
+    for (const std::pair<VertexId, VertexId>& entry : state.discovered) {
+        ++state.positionCounts[entry.first + 1];
+    }
+    for (size_t i = 1; i < state.positionCounts.size(); ++i) {
+        state.positionCounts[i] += state.positionCounts[i - 1];
+    }
+    size_t nextLevelBegin = traversal.size();
+    traversal.resize(nextLevelBegin + state.discovered.size());
+    for (const std::pair<VertexId, VertexId>& entry : state.discovered) {
+        VertexId vertex = entry.second;
+        traversal[nextLevelBegin + state.positionCounts[entry.first]++] = vertex;
+        state.visited[vertex / 64] |= std::uint64_t(1) << (vertex % 64);
+        state.unvisitedEdgeCount -= reverseNeighbors(vertex).size();
+    }
+
+    for (size_t i = levelBegin; i < levelEnd; ++i) {
+        VertexId vertex = traversal[i];
+        state.frontier[vertex / 64] &= ~(std::uint64_t(1) << (vertex % 64));
+    }
+}
+
+std::vector<FlightGraph::VertexId> FlightGraph::findShortestPath(VertexId origin, VertexId destination, ShortestPathAlgorithm algorithm) const {
+    std::vector<VertexId> shortestPath;
+    switch (algorithm) {
+        case ShortestPathAlgorithm::Dijkstra:
+            if (shortestPathTreeCache.canHoldTree(airportCodeList.size())) { //Otherwise every query would build a whole tree only to discard it
+                getShortestPathTree(origin)->getPath(destination, shortestPath);
+            } else {
+                findShortestPath(origin, destination, SearchContext::getThreadContext(0), shortestPath);
+            }
+            break;
+        case ShortestPathAlgorithm::BidirectionalDijkstra:
+            findShortestPathBidirectional(origin, destination, SearchContext::getThreadContext(0), SearchContext::getThreadContext(1), shortestPath);
+            break;
+        case ShortestPathAlgorithm::AStar:
+            findShortestPathAStar(origin, destination, SearchContext::getThreadContext(0), shortestPath);
+            break;
+        case ShortestPathAlgorithm::ALT:
+            findShortestPathALT(origin, destination, SearchContext::getThreadContext(0), shortestPath);
+            break;
     }
-    std::reverse(shortestPath.begin(), shortestPath.end());
     return shortestPath;
 }
 
+//Dijkstra's algorithm over a 4-ary heap with lazy insertion (improved distances are pushed as new entries and stale entries are skipped when popped)
+//Heap keys are the distance from source plus lowerBound(vertex), which is zero for plain Dijkstra and a consistent bound for A* (so a vertex's distance is final once it is popped either way)
+//onSettle(vertex) is called as each vertex is settled, and the search stops early once it returns true
+template <typename LowerBound, typename OnSettle>
+void FlightGraph::runDijkstra(VertexId source, bool reverse, SearchContext& context, const LowerBound& lowerBound, const OnSettle& onSettle) const {
+    context.reset(airportCodeList.size());
+    context.setDistance(source, 0.0, invalidVertexId);
+    context.heap.push(lowerBound(source), source);
+
+    while (!context.heap.empty()) {
+        VertexId minVertex = context.heap.top().second;
+        context.heap.pop();
+        if (context.isSettled(minVertex)) { //Stale entry
+            continue;
+        }
+        context.settle(minVertex);
+        if (onSettle(minVertex)) {
+            break;
+        }
+        double minDistance = context.getDistance(minVertex);
+        const NeighborRange& incident = reverse ? reverseNeighbors(minVertex) : neighbors(minVertex);
+        for (size_t i = 0; i < incident.size(); ++i) {
+            VertexId target = incident.targets[i];
+            if (!context.isSettled(target) && incident.weights[i] + minDistance < context.getDistance(target)) {
+                context.setDistance(target, incident.weights[i] + minDistance, minVertex);
+                context.heap.push(incident.weights[i] + minDistance + lowerBound(target), target);
+            }
+        }
+    }
+}
+
+//The search stops as soon as the destination is settled, since its distance and predecessor can no longer change
+void FlightGraph::findShortestPath(VertexId origin, VertexId destination, SearchContext& context, std::vector<VertexId>& shortestPath) const {
+    runDijkstra(origin, false, context, [](VertexId) { return 0.0; }, [destination](VertexId vertex) { return vertex == destination; });
+    extractPath(origin, destination, context, shortestPath);
+}
+
+void FlightGraph::extractPath(VertexId origin, VertexId destination, const SearchContext& context, std::vector<VertexId>& shortestPath) const {
+    shortestPath.clear();
+    shortestPath.push_back(destination);
+    if (context.getPredecessor(destination) == invalidVertexId) {
+        return;
+    }
+    VertexId currentVertex = destination;
+    while (currentVertex != origin) {
+        currentVertex = context.getPredecessor(currentVertex);
+        shortestPath.push_back(currentVertex);
+    }
+    std::reverse(shortestPath.begin(), shortestPath.end());
+}
+
+FlightGraph::ShortestPathTree FlightGraph::findShortestPathTree(const std::string& originAirportCode) const {
+    return findShortestPathTree(getVertexId(originAirportCode));
+}
+
+FlightGraph::ShortestPathTree FlightGraph::findShortestPathTree(VertexId origin) const {
+    ShortestPathTree tree;
+    findShortestPathTree(origin, SearchContext::getThreadContext(0), tree);
+    return tree;
+}
+
+//findAllShortestDistances relaxes edges exactly like findShortestPath, and a settled vertex's predecessor never changes, so each path in the tree is the path of a single query
+void FlightGraph::findShortestPathTree(VertexId origin, SearchContext& context, ShortestPathTree& tree) const {
+    std::vector<VertexId> settledOrder;
+    findAllShortestDistances(origin, false, context, settledOrder);
+    tree.origin = origin;
+    tree.distances.assign(airportCodeList.size(), std::numeric_limits<double>::max());
+    tree.parents.assign(airportCodeList.size(), invalidVertexId);
+    for (VertexId vertex : settledOrder) {
+        tree.distances[vertex] = context.getDistance(vertex);
+        tree.parents[vertex] = context.getPredecessor(vertex);
+    }
+}
+
+//The search runs outside the cache's lock, so two threads that miss on the same origin may both search (the second insert replaces the first tree, which is identical)
+std::shared_ptr<const FlightGraph::ShortestPathTree> FlightGraph::getShortestPathTree(VertexId origin) const {
+    std::shared_ptr<const ShortestPathTree> tree = shortestPathTreeCache.find(origin);
+    if (tree == nullptr) {
+        std::shared_ptr<ShortestPathTree> newTree = std::make_shared<ShortestPathTree>();
+        findShortestPathTree(origin, SearchContext::getThreadContext(0), *newTree);
+        shortestPathTreeCache.insert(newTree);
+        tree = newTree;
+    }
+    return tree;
+}
+
+FlightGraph::ShortestPathTreeCache::ShortestPathTreeCache(size_t memoryBudget) : memoryBudget(memoryBudget), memoryUsage(0), hitCount(0), missCount(0) {
+}
+
+FlightGraph::ShortestPathTreeCache::ShortestPathTreeCache(const ShortestPathTreeCache& other) : ShortestPathTreeCache(other.getMemoryBudget()) {
+}
+
+FlightGraph::ShortestPathTreeCache& FlightGraph::ShortestPathTreeCache::operator=(const ShortestPathTreeCache& other) {
+    if (this != &other) {
+        size_t otherMemoryBudget = other.getMemoryBudget();
+        std::lock_guard<std::mutex> lock(mutex);
+        trees.clear();
+        treesByOrigin.clear();
+        memoryBudget = otherMemoryBudget;
+        memoryUsage = 0;
+        hitCount = 0;
+        missCount = 0;
+    }
+    return *this;
+}
+
+size_t FlightGraph::ShortestPathTreeCache::getMemoryBudget() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return memoryBudget;
+}
+
+void FlightGraph::ShortestPathTreeCache::setMemoryBudget(size_t newMemoryBudget) {
+    std::lock_guard<std::mutex> lock(mutex);
+    memoryBudget = newMemoryBudget;
+    evict();
+}
+
+size_t FlightGraph::ShortestPathTreeCache::getMemoryUsage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return memoryUsage;
+}
+
+bool FlightGraph::ShortestPathTreeCache::canHoldTree(size_t vertexCount) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return sizeof(ShortestPathTree) + vertexCount * (sizeof(double) + sizeof(VertexId)) <= memoryBudget;
+}
+
+size_t FlightGraph::ShortestPathTreeCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return trees.size();
+}
+
+size_t FlightGraph::ShortestPathTreeCache::getHitCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hitCount;
+}
+
+size_t FlightGraph::ShortestPathTreeCache::getMissCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return missCount;
+}
+
+void FlightGraph::ShortestPathTreeCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    trees.clear();
+    treesByOrigin.clear();
+    memoryUsage = 0;
+    hitCount = 0;
+    missCount = 0;
+}
+
+std::shared_ptr<const FlightGraph::ShortestPathTree> FlightGraph::ShortestPathTreeCache::find(VertexId origin) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto position = treesByOrigin.find(origin);
+    if (position == treesByOrigin.end()) {
+        ++missCount;
+        return nullptr;
+    }
+    ++hitCount;
+    trees.splice(trees.begin(), trees, position->second); //Moves the tree to the front without invalidating iterators
+    return trees.front();
+}
+
+void FlightGraph::ShortestPathTreeCache::insert(const std::shared_ptr<const ShortestPathTree>& tree) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto position = treesByOrigin.find(tree->origin);
+    if (position != treesByOrigin.end()) {
+        memoryUsage -= getTreeMemory(**position->second);
+        trees.erase(position->second);
+        treesByOrigin.erase(position);
+    }
+    size_t treeMemory = getTreeMemory(*tree);
+    if (treeMemory > memoryBudget) {
+        return;
+    }
+    trees.push_front(tree);
+    treesByOrigin[tree->origin] = trees.begin();
+    memoryUsage += treeMemory;
+    evict();
+}
+
+size_t FlightGraph::ShortestPathTreeCache::getTreeMemory(const ShortestPathTree& tree) {
+    return sizeof(tree) + tree.distances.capacity() * sizeof(double) + tree.parents.capacity() * sizeof(VertexId);
+}
+
+void FlightGraph::ShortestPathTreeCache::evict() {
+    while (memoryUsage > memoryBudget) {
+        memoryUsage -= getTreeMemory(*trees.back());
+        treesByOrigin.erase(trees.back()->origin);
+        trees.pop_back();
+    }
+}
+
+void FlightGraph::ShortestPathTree::getPath(VertexId destination, std::vector<VertexId>& path) const {
+    path.clear();
+    path.push_back(destination);
+    if (parents[destination] == invalidVertexId) {
+        return;
+    }
+    VertexId currentVertex = destination;
+    while (currentVertex != origin) {
+        currentVertex = parents[currentVertex];
+        path.push_back(currentVertex);
+    }
+    std::reverse(path.begin(), path.end());
+}
+
+std::vector<FlightGraph::VertexId> FlightGraph::ShortestPathTree::getPath(VertexId destination) const {
+    std::vector<VertexId> path;
+    getPath(destination, path);
+    return path;
+}
+
+//A* search (https://en.wikipedia.org/wiki/A*_search_algorithm)
+//Heap keys are the distance from the origin plus a lower bound on the distance to the destination
+//Both bounds used here are consistent (they satisfy the triangle inequality along every edge), so a vertex's distance is final once it is popped and the early exit on the destination is exact
+template <typename LowerBound>
+double FlightGraph::findShortestPathGuided(VertexId origin, VertexId destination, SearchContext& context, std::vector<VertexId>& shortestPath, const LowerBound& lowerBound) const {
+    runDijkstra(origin, false, context, lowerBound, [destination](VertexId vertex) { return vertex == destination; });
+    extractPath(origin, destination, context, shortestPath);
+    return context.isSettled(destination) ? context.getDistance(destination) : std::numeric_limits<double>::max();
+}
+
+double FlightGraph::findShortestPathAStar(VertexId origin, VertexId destination, SearchContext& context, std::vector<VertexId>& shortestPath) const {
+    return findShortestPathGuided(origin, destination, context, shortestPath, [this, destination](VertexId vertex) {
+        return getGreatCircleLowerBound(vertex, destination);
+    });
+}
+
+//The maximum of the great-circle bound and the landmark bounds is still consistent, and it is never weaker than either
+double FlightGraph::findShortestPathALT(VertexId origin, VertexId destination, SearchContext& context, std::vector<VertexId>& shortestPath) const {
+    if (landmarks.empty()) {
+        return findShortestPathAStar(origin, destination, context, shortestPath);
+    }
+    const double* destinationFrom = landmarkDistancesFrom.data() + (size_t) destination * landmarks.size();
+    const double* destinationTo = landmarkDistancesTo.data() + (size_t) destination * landmarks.size();
+    return findShortestPathGuided(origin, destination, context, shortestPath, [this, destination, destinationFrom, destinationTo](VertexId vertex) {
+        return std::max(getGreatCircleLowerBound(vertex, destination), getLandmarkLowerBound(vertex, destinationFrom, destinationTo));
+    });
+}
+
+//Bidirectional Dijkstra (https://en.wikipedia.org/wiki/Bidirectional_search)
+//The forward search runs over the outgoing edges from the origin and the backward search runs over the incoming edges from the destination
+//Each iteration advances the search whose next key is smaller, and every edge relaxed into a vertex reached by the other search is a candidate path
+//The searches stop once the sum of the two minimum keys is at least the best candidate, since no unexplored path can be shorter
+double FlightGraph::findShortestPathBidirectional(VertexId origin, VertexId destination, SearchContext& forwardContext, SearchContext& backwardContext, std::vector<VertexId>& shortestPath) const {
+    forwardContext.reset(airportCodeList.size());
+    backwardContext.reset(airportCodeList.size());
+    forwardContext.setDistance(origin, 0.0, invalidVertexId);
+    forwardContext.heap.push(0.0, origin);
+    backwardContext.setDistance(destination, 0.0, invalidVertexId);
+    backwardContext.heap.push(0.0, destination);
+
+    double bestDistance = origin == destination ? 0.0 : std::numeric_limits<double>::max();
+    VertexId meetingVertex = origin == destination ? origin : invalidVertexId;
+
+    while (true) {
+        for (SearchContext* context : {&forwardContext, &backwardContext}) { //Discards stale entries so that the heap tops are true lower bounds
+            while (!context->heap.empty() && context->isSettled(context->heap.top().second)) {
+                context->heap.pop();
+            }
+        }
+        if (forwardContext.heap.empty() || backwardContext.heap.empty()) {
+            break;
+        }
+        if (forwardContext.heap.top().first + backwardContext.heap.top().first >= bestDistance) {
+            break;
+        }
+
+        bool isForward = forwardContext.heap.top().first <= backwardContext.heap.top().first;
+        SearchContext& context = isForward ? forwardContext : backwardContext;
+        const SearchContext& otherContext = isForward ? backwardContext : forwardContext;
+
+        VertexId minVertex = context.heap.top().second;
+        context.heap.pop();
+        context.settle(minVertex);
+        double minDistance = context.getDistance(minVertex);
+        const NeighborRange& incident = isForward ? neighbors(minVertex) : reverseNeighbors(minVertex);
+        for (size_t i = 0; i < incident.size(); ++i) {
+            VertexId target = incident.targets[i];
+            double targetDistance = incident.weights[i] + minDistance;
+            if (!context.isSettled(target) && targetDistance < context.getDistance(target)) {
+                context.setDistance(target, targetDistance, minVertex);
+                context.heap.push(targetDistance, target);
+            }
+            if (otherContext.isReached(target) && targetDistance + otherContext.getDistance(target) < bestDistance) {
+                bestDistance = targetDistance + otherContext.getDistance(target);
+                meetingVertex = target;
+            }
+        }
+    }
+
+    shortestPath.clear();
+    if (meetingVertex == invalidVertexId) { //Unreachable destination (the path only contains the destination, as in the unidirectional search)
+        shortestPath.push_back(destination);
+        return bestDistance;
+    }
+    for (VertexId currentVertex = meetingVertex; currentVertex != invalidVertexId; currentVertex = forwardContext.getPredecessor(currentVertex)) { //Meeting vertex back to the origin
+        shortestPath.push_back(currentVertex);
+    }
+    std::reverse(shortestPath.begin(), shortestPath.end());
+    for (VertexId currentVertex = backwardContext.getPredecessor(meetingVertex); currentVertex != invalidVertexId; currentVertex = backwardContext.getPredecessor(currentVertex)) { //Meeting vertex forward to the destination
+        shortestPath.push_back(currentVertex);
+    }
+    return bestDistance;
+}
+
 //(https://stackoverflow.com/questions/27663775/remove-consecutive-duplicate-values-in-a-string)
-std::vector<std::string> FlightGraph::findShortestLandmarkPath(const std::vector<std::string>& airportCodeVector) {
-    std::vector<std::string> shortestLandmarkPath;
+std::vector<FlightGraph::VertexId> FlightGraph::findShortestLandmarkPath(const std::vector<VertexId>& givenVertexVector, WaypointOrder order) const {
+    std::vector<VertexId> shortestLandmarkPath;
 
-    if (airportCodeVector.size() < 2) {
+    if (givenVertexVector.size() < 2) {
         return shortestLandmarkPath;
     }
 
-    for (size_t i = 0; i < airportCodeVector.size() - 1 ; ++i) {
-        const std::vector<std::string>& path = findShortestPath(airportCodeVector.at(i), airportCodeVector.at(i + 1));
+    const std::vector<VertexId>& vertexVector = order == WaypointOrder::Shortest ? findWaypointOrder(givenVertexVector) : givenVertexVector;
+    for (size_t i = 0; i < vertexVector.size() - 1 ; ++i) {
+        const std::vector<VertexId>& path = findShortestPath(vertexVector.at(i), vertexVector.at(i + 1));
         shortestLandmarkPath.insert(shortestLandmarkPath.end(), path.begin(), path.end());
     }
 
@@ -204,3 +1628,543 @@ std::vector<std::string> FlightGraph::findShortestLandmarkPath(const std::vector
 
     return shortestLandmarkPath;
 }
+
+std::vector<FlightGraph::VertexId> FlightGraph::findWaypointOrder(const std::vector<VertexId>& vertexVector) const {
+    size_t count = vertexVector.size();
+    if (count <= 3) { //At most one middle vertex
+        return vertexVector;
+    }
+    const std::vector<double>& distances = getWaypointDistances(vertexVector);
+
+    std::vector<size_t> order;
+    if (count - 2 <= maxExactWaypointCount) {
+        order = findExactWaypointOrder(distances, count);
+    } else {
+        //Local search starts from the shorter of the given order and the nearest neighbor tour
+        std::vector<size_t> givenOrder(count);
+        for (size_t i = 0; i < count; ++i) {
+            givenOrder.at(i) = i;
+        }
+        order.push_back(0);
+        std::vector<bool> visited(count, false);
+        for (size_t step = 1; step < count - 1; ++step) {
+            size_t nearest = count;
+            for (size_t candidate = 1; candidate < count - 1; ++candidate) {
+                if (!visited.at(candidate) && (nearest == count || distances.at(order.back() * count + candidate) < distances.at(order.back() * count + nearest))) {
+                    nearest = candidate;
+                }
+            }
+            visited.at(nearest) = true;
+            order.push_back(nearest);
+        }
+        order.push_back(count - 1);
+
+        double givenLength = 0.0;
+        double nearestLength = 0.0;
+        for (size_t i = 0; i + 1 < count; ++i) {
+            givenLength += distances.at(givenOrder.at(i) * count + givenOrder.at(i + 1));
+            nearestLength += distances.at(order.at(i) * count + order.at(i + 1));
+        }
+        if (givenLength <= nearestLength) {
+            order = givenOrder;
+        }
+        improveWaypointOrder(distances, order);
+    }
+
+    std::vector<VertexId> orderedVertexVector;
+    orderedVertexVector.reserve(count);
+    for (size_t index : order) {
+        orderedVertexVector.push_back(vertexVector.at(index));
+    }
+    return orderedVertexVector;
+}
+
+std::vector<double> FlightGraph::getWaypointDistances(const std::vector<VertexId>& vertexVector) const {
+    size_t count = vertexVector.size();
+    std::vector<VertexId> sortedVertices(vertexVector);
+    std::sort(sortedVertices.begin(), sortedVertices.end());
+    sortedVertices.erase(std::unique(sortedVertices.begin(), sortedVertices.end()), sortedVertices.end());
+
+    std::vector<double> distances(count * count);
+    std::unordered_map<VertexId, size_t> firstRows; //Row of the first occurrence of each vertex, which later occurrences copy
+    for (size_t i = 0; i < count; ++i) {
+        std::pair<std::unordered_map<VertexId, size_t>::iterator, bool> inserted = firstRows.insert(std::make_pair(vertexVector.at(i), i));
+        if (inserted.second) {
+            findDistanceRow(vertexVector.at(i), sortedVertices, vertexVector, SearchContext::getThreadContext(0), distances.data() + i * count);
+        } else {
+            std::copy(distances.begin() + inserted.first->second * count, distances.begin() + (inserted.first->second + 1) * count, distances.begin() + i * count);
+        }
+    }
+    for (double& distance : distances) {
+        if (distance == std::numeric_limits<double>::max()) {
+            distance = unreachableLegCost;
+        }
+    }
+    return distances;
+}
+
+//Held-Karp dynamic programming (https://en.wikipedia.org/wiki/Held%E2%80%93Karp_algorithm)
+//lengths[mask * middleCount + last] is the length of the shortest path that starts at the first vertex, visits exactly the middle vertices in mask, and ends at the middle vertex last
+std::vector<size_t> FlightGraph::findExactWaypointOrder(const std::vector<double>& distances, size_t count) {
+    size_t middleCount = count - 2;
+    size_t maskCount = size_t(1) << middleCount;
+    double infinity = std::numeric_limits<double>::infinity();
+    std::vector<double> lengths(maskCount * middleCount, infinity);
+    std::vector<std::uint8_t> previous(maskCount * middleCount, 0); //Middle vertex visited before last (only meaningful if mask has more than one vertex)
+
+    for (size_t last = 0; last < middleCount; ++last) {
+        lengths.at((size_t(1) << last) * middleCount + last) = distances.at(last + 1);
+    }
+    for (size_t mask = 1; mask < maskCount; ++mask) {
+        for (size_t last = 0; last < middleCount; ++last) {
+            double length = lengths[mask * middleCount + last];
+            if (!(mask & (size_t(1) << last)) || length == infinity) {
+                continue;
+            }
+            for (size_t next = 0; next < middleCount; ++next) {
+                if (mask & (size_t(1) << next)) {
+                    continue;
+                }
+                size_t nextIndex = (mask | (size_t(1) << next)) * middleCount + next;
+                double nextLength = length + distances[(last + 1) * count + next + 1];
+                if (nextLength < lengths[nextIndex]) {
+                    lengths[nextIndex] = nextLength;
+                    previous[nextIndex] = (std::uint8_t) last;
+                }
+            }
+        }
+    }
+
+    size_t fullMask = maskCount - 1;
+    size_t last = 0;
+    for (size_t candidate = 1; candidate < middleCount; ++candidate) {
+        if (lengths.at(fullMask * middleCount + candidate) + distances.at((candidate + 1) * count + count - 1) < lengths.at(fullMask * middleCount + last) + distances.at((last + 1) * count + count - 1)) {
+            last = candidate;
+        }
+    }
+
+    std::vector<size_t> order(count);
+    order.front() = 0;
+    order.back() = count - 1;
+    for (size_t mask = fullMask, position = count - 2; position > 0; --position) {
+        order.at(position) = last + 1;
+        size_t previousLast = previous.at(mask * middleCount + last);
+        mask &= ~(size_t(1) << last);
+        last = previousLast;
+    }
+    return order;
+}
+
+//2-opt reverses a segment and Or-opt moves a segment of up to three vertices elsewhere (https://en.wikipedia.org/wiki/2-opt)
+//Distances are not symmetric (routes are directed), so reversing a segment also changes the length of its inner legs - prefix sums of the legs in both directions give that change in O(1)
+//The first improving move found is applied, and the search restarts until no move improves the order by more than a rounding error
+void FlightGraph::improveWaypointOrder(const std::vector<double>& distances, std::vector<size_t>& order) {
+    size_t count = order.size();
+    auto distance = [&](size_t from, size_t to) { return distances[order[from] * count + order[to]]; };
+    std::vector<double> forwardPrefix(count, 0.0); //forwardPrefix[i] is the length of the legs before position i
+    std::vector<double> backwardPrefix(count, 0.0); //backwardPrefix[i] is the length of the same legs traveled backward
+    double epsilon = 1e-9;
+
+    bool improved = true;
+    while (improved) {
+        improved = false;
+        for (size_t i = 1; i < count; ++i) {
+            forwardPrefix[i] = forwardPrefix[i - 1] + distance(i - 1, i);
+            backwardPrefix[i] = backwardPrefix[i - 1] + distance(i, i - 1);
+        }
+
+        //2-opt: reverse positions [first, last]
+        for (size_t first = 1; first + 1 < count - 1 && !improved; ++first) {
+            for (size_t last = first + 1; last < count - 1 && !improved; ++last) {
+                double change = distance(first - 1, last) + distance(first, last + 1) - distance(first - 1, first) - distance(last, last + 1);
+                change += (backwardPrefix[last] - backwardPrefix[first]) - (forwardPrefix[last] - forwardPrefix[first]);
+                if (change < -epsilon) {
+                    std::reverse(order.begin() + first, order.begin() + last + 1);
+                    improved = true;
+                }
+            }
+        }
+
+        //Or-opt: move positions [first, first + length) between the positions target and target + 1
+        for (size_t length = 1; length <= 3 && !improved; ++length) {
+            for (size_t first = 1; first + length < count && !improved; ++first) {
+                size_t last = first + length - 1;
+                double removal = distance(first - 1, last + 1) - distance(first - 1, first) - distance(last, last + 1);
+                for (size_t target = 0; target + 1 < count && !improved; ++target) {
+                    if (target + 1 >= first && target <= last) { //The gap touches the segment
+                        continue;
+                    }
+                    double change = removal + distance(target, first) + distance(last, target + 1) - distance(target, target + 1);
+                    if (change < -epsilon) {
+                        std::vector<size_t> segment(order.begin() + first, order.begin() + last + 1);
+                        order.erase(order.begin() + first, order.begin() + last + 1);
+                        size_t insertPosition = target < first ? target + 1 : target + 1 - length;
+                        order.insert(order.begin() + insertPosition, segment.begin(), segment.end());
+                        improved = true;
+                    }
+                }
+            }
+        }
+    }
+}
+
+std::vector<std::vector<std::string>> FlightGraph::findShortestPaths(const std::vector<std::pair<std::string, std::string>>& queries, ThreadPool& pool) const {
+    std::vector<std::pair<VertexId, VertexId>> vertexQueries;
+    vertexQueries.reserve(queries.size());
+    for (const std::pair<std::string, std::string>& query : queries) {
+        vertexQueries.push_back(std::make_pair(getVertexId(query.first), getVertexId(query.second)));
+    }
+
+    const std::vector<std::vector<VertexId>>& paths = findShortestPaths(vertexQueries, pool);
+
+    std::vector<std::vector<std::string>> shortestPaths(paths.size());
+    pool.run(paths.size(), [&](size_t i, size_t) {
+        shortestPaths.at(i).reserve(paths.at(i).size());
+        for (VertexId vertex : paths.at(i)) {
+            shortestPaths.at(i).push_back(airportCodeList.at(vertex));
+        }
+    });
+    return shortestPaths;
+}
+
+//Queries are bucketed by origin like the reverse CSR arrays (counting, prefix sum, and placement), so the queries of one origin are contiguous and in input order
+std::vector<std::vector<FlightGraph::VertexId>> FlightGraph::findShortestPaths(const std::vector<std::pair<VertexId, VertexId>>& queries, ThreadPool& pool) const {
+    std::vector<size_t> originOffsets(airportCodeList.size() + 1, 0);
+    for (const std::pair<VertexId, VertexId>& query : queries) {
+        ++originOffsets.at(query.first + 1);
+    }
+    for (size_t i = 0; i < airportCodeList.size(); ++i) {
+        originOffsets.at(i + 1) += originOffsets.at(i);
+    }
+    std::vector<size_t> queriesByOrigin(queries.size());
+    std::vector<size_t> nextPosition(originOffsets.begin(), originOffsets.end() - 1);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        queriesByOrigin.at(nextPosition.at(queries.at(i).first)++) = i;
+    }
+    std::vector<VertexId> origins; //Distinct origins, which are the tasks
+    for (VertexId vertex = 0; vertex < airportCodeList.size(); ++vertex) {
+        if (originOffsets.at(vertex) < originOffsets.at(vertex + 1)) {
+            origins.push_back(vertex);
+        }
+    }
+
+    std::vector<std::vector<VertexId>> shortestPaths(queries.size());
+    std::vector<SearchContext> contexts(pool.getThreadCount());
+    std::vector<std::vector<VertexId>> destinations(pool.getThreadCount()); //Scratch buffer of each worker
+    pool.run(origins.size(), [&](size_t task, size_t worker) {
+        VertexId origin = origins.at(task);
+        std::vector<VertexId>& originDestinations = destinations.at(worker);
+        originDestinations.clear();
+        for (size_t i = originOffsets.at(origin); i < originOffsets.at(origin + 1); ++i) {
+            originDestinations.push_back(queries.at(queriesByOrigin.at(i)).second);
+        }
+        std::sort(originDestinations.begin(), originDestinations.end());
+        originDestinations.erase(std::unique(originDestinations.begin(), originDestinations.end()), originDestinations.end());
+
+        settleDestinations(origin, originDestinations, contexts.at(worker));
+        for (size_t i = originOffsets.at(origin); i < originOffsets.at(origin + 1); ++i) {
+            size_t query = queriesByOrigin.at(i);
+            extractPath(origin, queries.at(query).second, contexts.at(worker), shortestPaths.at(query));
+        }
+    });
+    return shortestPaths;
+}
+
+std::vector<double> FlightGraph::distanceMatrix(const std::vector<std::string>& sourceAirportCodes, const std::vector<std::string>& targetAirportCodes, ThreadPool& pool) const {
+    std::vector<VertexId> sources;
+    sources.reserve(sourceAirportCodes.size());
+    for (const std::string& code : sourceAirportCodes) {
+        sources.push_back(getVertexId(code));
+    }
+    std::vector<VertexId> targets;
+    targets.reserve(targetAirportCodes.size());
+    for (const std::string& code : targetAirportCodes) {
+        targets.push_back(getVertexId(code));
+    }
+    return distanceMatrix(sources, targets, pool);
+}
+
+//Rows of repeated sources are copied from the first row with the same source, so each distinct source is searched once
+std::vector<double> FlightGraph::distanceMatrix(const std::vector<VertexId>& sources, const std::vector<VertexId>& targets, ThreadPool& pool) const {
+    std::vector<VertexId> sortedTargets(targets);
+    std::sort(sortedTargets.begin(), sortedTargets.end());
+    sortedTargets.erase(std::unique(sortedTargets.begin(), sortedTargets.end()), sortedTargets.end());
+
+    std::vector<size_t> rowsBySource(sources.size()); //Row indices grouped by source (stable, so the first row of each group is the first occurrence)
+    for (size_t i = 0; i < sources.size(); ++i) {
+        rowsBySource.at(i) = i;
+    }
+    std::stable_sort(rowsBySource.begin(), rowsBySource.end(), [&](size_t a, size_t b) { return sources.at(a) < sources.at(b); });
+    std::vector<size_t> groupOffsets; //Group i occupies positions [groupOffsets.at(i), groupOffsets.at(i + 1)) of rowsBySource
+    for (size_t i = 0; i < rowsBySource.size(); ++i) {
+        if (i == 0 || sources.at(rowsBySource.at(i)) != sources.at(rowsBySource.at(i - 1))) {
+            groupOffsets.push_back(i);
+        }
+    }
+    groupOffsets.push_back(rowsBySource.size());
+
+    size_t columnCount = targets.size();
+    std::vector<double> distances(sources.size() * columnCount);
+    std::vector<SearchContext> contexts(pool.getThreadCount());
+    pool.run(groupOffsets.size() - 1, [&](size_t task, size_t worker) {
+        size_t firstRow = rowsBySource.at(groupOffsets.at(task));
+        findDistanceRow(sources.at(firstRow), sortedTargets, targets, contexts.at(worker), distances.data() + firstRow * columnCount);
+        for (size_t i = groupOffsets.at(task) + 1; i < groupOffsets.at(task + 1); ++i) {
+            std::copy(distances.begin() + firstRow * columnCount, distances.begin() + (firstRow + 1) * columnCount, distances.begin() + rowsBySource.at(i) * columnCount);
+        }
+    });
+    return distances;
+}
+
+void FlightGraph::findDistanceRow(VertexId source, const std::vector<VertexId>& sortedTargets, const std::vector<VertexId>& targets, SearchContext& context, double* row) const {
+    if (targets.empty()) { //settleDestinations would search the whole graph
+        return;
+    }
+    settleDestinations(source, sortedTargets, context);
+    for (size_t j = 0; j < targets.size(); ++j) {
+        row[j] = context.isSettled(targets[j]) ? context.getDistance(targets[j]) : std::numeric_limits<double>::max();
+    }
+}
+
+//Same search as findShortestPath(origin, destination, context, shortestPath) with a set of destinations
+//A settled vertex's predecessor never changes, so each destination gets exactly the path a single query would find
+void FlightGraph::settleDestinations(VertexId origin, const std::vector<VertexId>& destinations, SearchContext& context) const {
+    size_t unsettledCount = destinations.size();
+    runDijkstra(origin, false, context, [](VertexId) { return 0.0; }, [&](VertexId vertex) {
+        return std::binary_search(destinations.begin(), destinations.end(), vertex) && --unsettledCount == 0;
+    });
+}
+
+void FlightGraph::findAllShortestDistances(VertexId source, bool reverse, SearchContext& context, std::vector<VertexId>& settledOrder) const {
+    settledOrder.clear();
+    runDijkstra(source, reverse, context, [](VertexId) { return 0.0; }, [&settledOrder](VertexId vertex) {
+        settledOrder.push_back(vertex);
+        return false;
+    });
+}
+
+//Landmarks are chosen one at a time, and the distances from and to each new landmark are stored before the next one is chosen (both strategies use the current bounds)
+//The first landmark (and the pool of candidates) comes from the airport with the most outgoing routes, which lies in the main component
+//Avoid: (https://www.microsoft.com/en-us/research/publication/computing-point-to-point-shortest-paths-from-external-memory/)
+void FlightGraph::preprocessLandmarks(size_t landmarkCount, LandmarkSelection selection) {
+    size_t vertexCount = airportCodeList.size();
+    landmarkCount = std::min(landmarkCount, vertexCount);
+    double infinity = std::numeric_limits<double>::infinity();
+
+    std::vector<VertexId> newLandmarks;
+    std::vector<std::vector<double>> distancesFrom; //Landmark-major during preprocessing
+    std::vector<std::vector<double>> distancesTo;
+
+    SearchContext context;
+    std::vector<VertexId> settledOrder;
+
+    VertexId hub = 0;
+    for (VertexId vertex = 0; vertex < vertexCount; ++vertex) {
+        if (neighbors(vertex).size() > neighbors(hub).size()) {
+            hub = vertex;
+        }
+    }
+    findAllShortestDistances(hub, false, context, settledOrder);
+    std::vector<VertexId> candidates(settledOrder); //Airports reachable from the hub
+    std::mt19937 generator(2022); //Fixed seed, so preprocessing is deterministic
+
+    for (size_t landmarkIndex = 0; landmarkIndex < landmarkCount && vertexCount > 0; ++landmarkIndex) {
+        VertexId landmark = invalidVertexId;
+        if (newLandmarks.empty()) { //Farthest airport from the hub
+            landmark = settledOrder.back();
+        } else {
+            if (selection == LandmarkSelection::Avoid) {
+                for (size_t attempt = 0; attempt < 8 && landmark == invalidVertexId; ++attempt) { //A sampled tree may already be fully covered, so a few roots are tried
+                    //Grow a shortest path tree from a random root, weight each vertex by how much its distance exceeds the current lower bound, and sum the weights of each subtree
+                    //Subtrees that contain a landmark are already covered, so their size is zero
+                    VertexId root = candidates.at(std::uniform_int_distribution<size_t>(0, candidates.size() - 1)(generator));
+                    findAllShortestDistances(root, false, context, settledOrder);
+                    std::vector<double> size(vertexCount, 0.0);
+                    std::vector<bool> hasLandmark(vertexCount, false);
+                    for (VertexId existingLandmark : newLandmarks) {
+                        hasLandmark.at(existingLandmark) = true;
+                    }
+                    for (size_t i = settledOrder.size(); i-- > 0;) { //Children are settled after their parents
+                        VertexId vertex = settledOrder.at(i);
+                        double lowerBound = 0.0;
+                        for (size_t j = 0; j < newLandmarks.size(); ++j) {
+                            if (distancesFrom.at(j).at(vertex) != infinity && distancesFrom.at(j).at(root) != infinity) {
+                                lowerBound = std::max(lowerBound, distancesFrom.at(j).at(vertex) - distancesFrom.at(j).at(root));
+                            }
+                            if (distancesTo.at(j).at(root) != infinity && distancesTo.at(j).at(vertex) != infinity) {
+                                lowerBound = std::max(lowerBound, distancesTo.at(j).at(root) - distancesTo.at(j).at(vertex));
+                            }
+                        }
+                        size.at(vertex) = hasLandmark.at(vertex) ? 0.0 : size.at(vertex) + context.getDistance(vertex) - lowerBound;
+                        VertexId parent = context.getPredecessor(vertex);
+                        if (parent != invalidVertexId) {
+                            if (hasLandmark.at(vertex)) {
+                                hasLandmark.at(parent) = true;
+                            }
+                            size.at(parent) += size.at(vertex);
+                        }
+                    }
+
+                    //Start at the largest subtree and follow the largest child down to a leaf
+                    VertexId current = invalidVertexId;
+                    for (VertexId vertex : settledOrder) {
+                        if (size.at(vertex) > 0.0 && (current == invalidVertexId || size.at(vertex) > size.at(current))) {
+                            current = vertex;
+                        }
+                    }
+                    std::vector<VertexId> largestChild(vertexCount, invalidVertexId);
+                    for (VertexId vertex : settledOrder) {
+                        VertexId parent = context.getPredecessor(vertex);
+                        if (parent != invalidVertexId && size.at(vertex) > 0.0 && (largestChild.at(parent) == invalidVertexId || size.at(vertex) > size.at(largestChild.at(parent)))) {
+                            largestChild.at(parent) = vertex;
+                        }
+                    }
+                    while (current != invalidVertexId && largestChild.at(current) != invalidVertexId) {
+                        current = largestChild.at(current);
+                    }
+                    landmark = current;
+                }
+            }
+            if (landmark == invalidVertexId) { //Farthest (also the fallback when every sampled tree is already covered)
+                double bestDistance = -1.0;
+                for (VertexId vertex : candidates) {
+                    double closestDistance = infinity;
+                    for (const std::vector<double>& distances : distancesFrom) {
+                        closestDistance = std::min(closestDistance, distances.at(vertex));
+                    }
+                    if (closestDistance != infinity && closestDistance > bestDistance) {
+                        bestDistance = closestDistance;
+                        landmark = vertex;
+                    }
+                }
+            }
+        }
+
+        if (landmark == invalidVertexId || std::find(newLandmarks.begin(), newLandmarks.end(), landmark) != newLandmarks.end()) { //Every candidate is covered
+            break;
+        }
+        newLandmarks.push_back(landmark);
+
+        distancesFrom.push_back(std::vector<double>(vertexCount, infinity));
+        findAllShortestDistances(landmark, false, context, settledOrder);
+        for (VertexId vertex : settledOrder) {
+            distancesFrom.back().at(vertex) = context.getDistance(vertex);
+        }
+        distancesTo.push_back(std::vector<double>(vertexCount, infinity));
+        findAllShortestDistances(landmark, true, context, settledOrder);
+        for (VertexId vertex : settledOrder) {
+            distancesTo.back().at(vertex) = context.getDistance(vertex);
+        }
+    }
+
+    //Transposes the distances into the vertex-major layout used by queries
+    landmarks = newLandmarks;
+    landmarkDistancesFrom = std::vector<double>(vertexCount * landmarks.size());
+    landmarkDistancesTo = std::vector<double>(vertexCount * landmarks.size());
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+        for (size_t i = 0; i < landmarks.size(); ++i) {
+            landmarkDistancesFrom.at(vertex * landmarks.size() + i) = distancesFrom.at(i).at(vertex);
+            landmarkDistancesTo.at(vertex * landmarks.size() + i) = distancesTo.at(i).at(vertex);
+        }
+    }
+}
+
+//File format: "FGALT" magic, format version, vertex count, graph checksum, landmark count, the airport code of each landmark, and then landmarkDistancesFrom and landmarkDistancesTo
+bool FlightGraph::saveLandmarks(const std::string& filepath) const {
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::uint32_t version = 2;
+    std::uint64_t vertexCount = airportCodeList.size();
+    std::uint64_t checksum = getGraphChecksum();
+    std::uint64_t landmarkCount = landmarks.size();
+    file.write("FGALT", 5);
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char*>(&vertexCount), sizeof(vertexCount));
+    file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+    file.write(reinterpret_cast<const char*>(&landmarkCount), sizeof(landmarkCount));
+    for (VertexId landmark : landmarks) {
+        const std::string& code = airportCodeList.at(landmark);
+        std::uint32_t codeSize = (std::uint32_t) code.size();
+        file.write(reinterpret_cast<const char*>(&codeSize), sizeof(codeSize));
+        file.write(code.data(), codeSize);
+    }
+    file.write(reinterpret_cast<const char*>(landmarkDistancesFrom.data()), landmarkDistancesFrom.size() * sizeof(double));
+    file.write(reinterpret_cast<const char*>(landmarkDistancesTo.data()), landmarkDistancesTo.size() * sizeof(double));
+    return (bool) file;
+}
+
+bool FlightGraph::loadLandmarks(const std::string& filepath) {
+    std::ifstream file(filepath, std::ios::binary);
+    char magic[5];
+    std::uint32_t version = 0;
+    std::uint64_t vertexCount = 0;
+    std::uint64_t checksum = 0;
+    std::uint64_t landmarkCount = 0;
+    file.read(magic, 5);
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&vertexCount), sizeof(vertexCount));
+    file.read(reinterpret_cast<char*>(&checksum), sizeof(checksum));
+    file.read(reinterpret_cast<char*>(&landmarkCount), sizeof(landmarkCount));
+    if (!file || std::string(magic, 5) != "FGALT" || version != 2 || vertexCount != airportCodeList.size() || checksum != getGraphChecksum() || landmarkCount > vertexCount) {
+        return false;
+    }
+
+    size_t maxCodeSize = 0; //Every landmark is an airport of this graph, so no valid code is longer
+    for (const std::string& code : airportCodeList) {
+        maxCodeSize = std::max(maxCodeSize, code.size());
+    }
+    std::vector<VertexId> newLandmarks;
+    for (std::uint64_t i = 0; i < landmarkCount; ++i) {
+        std::uint32_t codeSize = 0;
+        file.read(reinterpret_cast<char*>(&codeSize), sizeof(codeSize));
+        if (!file || codeSize > maxCodeSize) { //A corrupt size must not allocate a huge string
+            return false;
+        }
+        std::string code(codeSize, ' ');
+        file.read(&code[0], code.size());
+        if (!file || airportCodeMap.count(code) == 0) {
+            return false;
+        }
+        newLandmarks.push_back(getVertexId(code));
+    }
+
+    std::vector<double> newDistancesFrom(vertexCount * landmarkCount);
+    std::vector<double> newDistancesTo(vertexCount * landmarkCount);
+    file.read(reinterpret_cast<char*>(newDistancesFrom.data()), newDistancesFrom.size() * sizeof(double));
+    file.read(reinterpret_cast<char*>(newDistancesTo.data()), newDistancesTo.size() * sizeof(double));
+    if (!file) {
+        return false;
+    }
+
+    landmarks = newLandmarks;
+    landmarkDistancesFrom = newDistancesFrom;
+    landmarkDistancesTo = newDistancesTo;
+    return true;
+}
+
+double FlightGraph::getLandmarkLowerBound(VertexId vertex, VertexId destination) const {
+    if (landmarks.empty()) {
+        return 0.0;
+    }
+    return getLandmarkLowerBound(vertex, landmarkDistancesFrom.data() + (size_t) destination * landmarks.size(), landmarkDistancesTo.data() + (size_t) destination * landmarks.size());
+}
+
+//Terms with an infinite distance are skipped, since they do not give a finite bound
+//Like the great-circle bound, the result is lowered by a meter to absorb rounding in the stored distances
+double FlightGraph::getLandmarkLowerBound(VertexId vertex, const double* destinationFrom, const double* destinationTo) const {
+    const double* vertexFrom = landmarkDistancesFrom.data() + (size_t) vertex * landmarks.size();
+    const double* vertexTo = landmarkDistancesTo.data() + (size_t) vertex * landmarks.size();
+    double infinity = std::numeric_limits<double>::infinity();
+    double bound = 0.0;
+    for (size_t i = 0; i < landmarks.size(); ++i) {
+        if (destinationFrom[i] != infinity && vertexFrom[i] != infinity) {
+            bound = std::max(bound, destinationFrom[i] - vertexFrom[i]); //d(v, t) >= d(L, t) - d(L, v)
+        }
+        if (vertexTo[i] != infinity && destinationTo[i] != infinity) {
+            bound = std::max(bound, vertexTo[i] - destinationTo[i]); //d(v, t) >= d(v, L) - d(t, L)
+        }
+    }
+    return bound > 0.001 ? bound - 0.001 : 0.0;
+}
@@ -1,15 +1,31 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <limits>
 #include <algorithm>
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <queue>
+#include <random>
+#include <thread>
+#include <atomic>
+
+#include "SearchContext.h"
+#include "ThreadPool.h"
+#include "AirportCode.h"
+#include "MappedFile.h"
+#include "CsvReader.h"
 
 /*
 Notes:
@@ -19,11 +35,12 @@ See OpenFlights (https://openflights.org/data.html) for information about the fo
 
 Some airports do not have an OpenFlights ID and are not in airports.dat (see routes.dat line 67503)
 Some distinct routes have the same starting and ending airport (e.g. the route is offered by two different airlines) (see routes.dat lines 66149 and 667663)
-Some airport names contain a comma
+Some airport names contain a comma (CsvReader keeps quoted fields together)
 Some airports do not have a code
+Airport codes in routes.dat are 3-letter IATA or 4-letter ICAO codes, so each one is also stored packed in an AirportCode (the constructor throws std::invalid_argument for a longer code)
 Some airport routes contain airports that are not stored in the OpenFlights Airports Database (see routes.dat line 30550)
 
-If testing on very large datasets, there may be memory issues since this graph uses an adjacency matrix
+The graph is stored in compressed sparse row (CSR) form, so memory usage is O(|V| + |E|)
 
 FlightGraph has undefined behavior on files that do not follow the OpenFlight format
 
@@ -38,12 +55,103 @@ For this dataset, |V| < |E| << |V|^2
 
 FlightGraph is designed to run on EWS
 
-Methods may produce undefined behavior if there is more than one connected component or there is a lack of outgoing routes
+The graph may have several connected components and airports without outgoing routes: breadth-first searches, components, and stronglyConnectedComponents cover every component, and a path to an unreachable destination only contains the destination
 */
 
 class FlightGraph {
     public:
-        FlightGraph(const std::string& routeFilepath, const std::string& airportFilepath); //Constructor assigns all the variables
+        typedef std::uint32_t VertexId; //Dense vertex ID, which is an airport's index in airportCodeList
+        static constexpr VertexId invalidVertexId = std::numeric_limits<VertexId>::max(); //Sentinel for a missing vertex (e.g., the predecessor of the origin)
+        static constexpr double radiusOfEarth = 6378.137; //Equatorial radius in kilometers (used by all great-circle distances)
+
+        //Outgoing edges of one vertex, which is a contiguous slice of the CSR arrays (iterating over it yields the target vertex IDs)
+        struct NeighborRange {
+            const VertexId* targets; //Target of the first edge
+            const double* weights; //Weight of the first edge
+            size_t count; //Number of edges
+
+            const VertexId* begin() const { return targets; }
+            const VertexId* end() const { return targets + count; }
+            size_t size() const { return count; }
+        };
+
+        //Shortest paths from one origin to every airport, stored as two flat arrays indexed by vertex ID (12 bytes per airport)
+        //Any number of paths can be read from one tree, so callers that need many destinations from one origin pay for a single search
+        struct ShortestPathTree {
+            VertexId origin; //Root of the tree
+            std::vector<double> distances; //Length of the shortest path to each vertex (std::numeric_limits<double>::max() if it is unreachable)
+            std::vector<VertexId> parents; //Predecessor of each vertex on its shortest path (invalidVertexId for the origin and for unreachable vertices)
+
+            bool isReachable(VertexId destination) const { return distances[destination] != std::numeric_limits<double>::max(); }
+            void getPath(VertexId destination, std::vector<VertexId>& path) const; //Writes the path from the origin to destination into path (reusing its memory) - only the destination if it is unreachable, as in findShortestPath
+            std::vector<VertexId> getPath(VertexId destination) const; //Returns the path from the origin to destination
+        };
+
+        //Least recently used cache of shortest path trees keyed by origin, bounded by the memory of the cached trees
+        //Trees are shared, so a tree that is evicted stays valid for callers that still hold it
+        //All methods are thread-safe, and copying a cache copies its memory budget but not its trees or counters (a copy may belong to a different graph)
+        class ShortestPathTreeCache {
+            public:
+                static constexpr size_t defaultMemoryBudget = 8 << 20; //About 200 trees of OpenFlights, or 4 trees of a graph with 170000 airports
+
+                ShortestPathTreeCache(size_t memoryBudget = defaultMemoryBudget); //Creates an empty cache that holds trees of at most memoryBudget bytes in total (0 disables the cache)
+                ShortestPathTreeCache(const ShortestPathTreeCache& other);
+                ShortestPathTreeCache& operator=(const ShortestPathTreeCache& other);
+
+                size_t getMemoryBudget() const;
+                void setMemoryBudget(size_t memoryBudget); //Changes the budget and evicts the least recently used trees until the cached trees fit
+                size_t getMemoryUsage() const; //Returns the number of bytes used by the cached trees
+                bool canHoldTree(size_t vertexCount) const; //Returns true if a tree of a graph with vertexCount vertices fits in the budget (false if the cache is disabled)
+                size_t size() const; //Returns the number of cached trees
+                size_t getHitCount() const; //Returns the number of lookups that found their tree
+                size_t getMissCount() const; //Returns the number of lookups that did not find their tree
+                void clear(); //Removes every tree and resets the counters
+
+                std::shared_ptr<const ShortestPathTree> find(VertexId origin); //Returns the tree of origin and marks it as most recently used (nullptr if it is not cached) - counts a hit or a miss
+                void insert(const std::shared_ptr<const ShortestPathTree>& tree); //Adds a tree as the most recently used one (replacing any tree with the same origin) and evicts the least recently used trees until the budget is met - a tree larger than the budget is not cached
+
+            private:
+                static size_t getTreeMemory(const ShortestPathTree& tree); //Returns the number of bytes used by a tree
+                void evict(); //Removes the least recently used trees until memoryUsage <= memoryBudget (the mutex must be held)
+
+                mutable std::mutex mutex; //Guards the fields below
+                std::list<std::shared_ptr<const ShortestPathTree>> trees; //Most recently used tree first
+                std::unordered_map<VertexId, std::list<std::shared_ptr<const ShortestPathTree>>::iterator> treesByOrigin;
+                size_t memoryBudget;
+                size_t memoryUsage;
+                size_t hitCount;
+                size_t missCount;
+        };
+
+        struct ComponentLabels { //Weakly or strongly connected components of the graph (see components and stronglyConnectedComponents)
+            std::vector<VertexId> componentIds; //Component of each vertex, where components are numbered in order of their smallest vertex ID
+            std::vector<size_t> componentSizes; //Number of vertices in each component
+        };
+
+        enum class ShortestPathAlgorithm { //Search strategies for point-to-point shortest path queries (all of them return a shortest path)
+            Dijkstra, //Unidirectional search from the origin
+            BidirectionalDijkstra, //Searches forward from the origin and backward from the destination until the searches meet
+            AStar, //Unidirectional search guided by the great-circle distance to the destination
+            ALT //A* guided by landmark distances and the triangle inequality (see preprocessLandmarks), which falls back to AStar if there are no landmarks
+        };
+
+        enum class WaypointOrder { //Orders in which findShortestLandmarkPath visits the intermediate airports
+            Given, //In the order of the input vector
+            Shortest //In the order that minimizes the total distance (see findWaypointOrder)
+        };
+
+        enum class LandmarkSelection { //Strategies for choosing ALT landmarks
+            Farthest, //Each landmark is the reachable airport farthest from the landmarks chosen so far
+            Avoid //Each landmark is a leaf of the subtree of a shortest path tree that the current landmarks cover worst (Goldberg and Werneck)
+        };
+
+        FlightGraph(const std::string& routeFilepath, const std::string& airportFilepath, size_t threadCount = 1); //Constructor assigns all the variables (the route file is parsed in threadCount chunks in parallel, and the result does not depend on threadCount)
+        FlightGraph(); //Creates an empty graph (to be filled by loadSnapshot)
+
+        //Binary snapshots store the parsed graph (airport codes, coordinates, routes, and both CSR structures with their weights), so loading one skips parsing and the distance computations
+        bool saveSnapshot(const std::string& filepath) const; //Writes the graph to a snapshot file (landmarks are not included) - returns false if the file could not be written
+        bool loadSnapshot(const std::string& filepath); //Replaces the graph with the one in a snapshot file and clears any landmarks - returns false (and keeps the current graph) if the file is missing, has another version, or fails its checksum or structure checks
+
         std::vector<std::string> getIncidentAirportCodes(const std::string& originAirportCode); //Returns vertices (airport codes) incident to the given vertex
         bool areAdjacent(const std::string& originAirportCode, const std::string& destinationAirportCode); //Returns whether two airports have an edge between them - note that invalid airport codes will result in undefined behavior
 
@@ -53,22 +161,167 @@ class FlightGraph {
 
         std::vector<std::string> breadthFirstSearch(const std::string& airportCode, std::vector<bool>& visited); //Helper function to find breadth-first search traversal of components disconnected from root airport code
 
-        std::vector<std::string> findShortestPath(const std::string& originAirportCode, const std::string& destinationAirportCode); //Returns the shortest path (a vector of airport codes) using Dijkstra’s Algorithm
+        std::vector<std::string> findShortestPath(const std::string& originAirportCode, const std::string& destinationAirportCode, ShortestPathAlgorithm algorithm = ShortestPathAlgorithm::Dijkstra); //Returns the shortest path (a vector of airport codes) using Dijkstra’s Algorithm (if the destination is unreachable, the path only contains the destination)
+
+        std::vector<std::string> findShortestLandmarkPath(const std::vector<std::string>& airportCodeVector, WaypointOrder order = WaypointOrder::Given); //Takes in a vector where the first code is the origin, the last code is the final destination, and the middle codes are the intermediate landmarks - the function returns the shortest path from the origin to the destination through the landmarks (visited in the given order or in the order that minimizes the total distance)
+
+        //Vertex ID API
+        //These methods take and return dense vertex IDs, so they avoid the string lookups of the methods above
+        //The string-keyed methods resolve airport codes once and then call these methods
+        //Note that invalid vertex IDs will result in undefined behavior
+        size_t getVertexCount() const; //Returns the number of vertices (airports)
+        VertexId getVertexId(const std::string& airportCode) const; //Returns the vertex ID of an airport code (throws std::out_of_range if the code is not in the graph)
+        VertexId getVertexId(AirportCode airportCode) const; //Packed code version of getVertexId(airportCode)
+        VertexId findVertexId(AirportCode airportCode) const; //Returns the vertex ID of a packed airport code (invalidVertexId if the code is not in the graph) - O(1) for 3-letter IATA codes
+        const std::string& getAirportCode(VertexId vertex) const; //Returns the airport code of a vertex ID
+        std::uint64_t getGraphChecksum() const; //FNV-1a hash of the airport codes and of the targets and weights of every edge, which ties saved landmarks and hub labels to their graph
+
+        double getGreatCircleLowerBound(VertexId origin, VertexId destination) const; //Returns a lower bound on the length of any path between two airports, computed from their unit-sphere vectors (a dot product plus acos)
+        NeighborRange neighbors(VertexId vertex) const; //Returns the outgoing edges of a vertex without copying them
+        NeighborRange reverseNeighbors(VertexId vertex) const; //Returns the incoming edges of a vertex without copying them (iterating over it yields the source vertex IDs)
+        bool areAdjacent(VertexId origin, VertexId destination) const; //Returns whether there is an edge from origin to destination
+
+        //Breadth-first searches are direction-optimizing (https://scottbeamer.net/pubs/beamer-sc2012.pdf) - each level is expanded top-down from the frontier or bottom-up from the unvisited vertices, whichever scans fewer edges
+        //Both directions produce exactly the order of a FIFO queue, so the traversal does not depend on the switching
+        std::vector<std::vector<VertexId>> breadthFirstSearch(VertexId root) const; //Vertex ID version of breadthFirstSearch(rootAirportCode)
+        std::vector<VertexId> breadthFirstSearch(VertexId root, std::vector<bool>& visited) const; //Vertex ID version of breadthFirstSearch(airportCode, visited)
+
+        //Parallel breadth-first search, which expands each level as tasks on the pool (https://en.wikipedia.org/wiki/Parallel_breadth-first_search)
+        //The result is identical to breadthFirstSearch(root) for any number of threads
+        std::vector<std::vector<std::string>> breadthFirstSearch(const std::string& rootAirportCode, ThreadPool& pool) const; //Parallel version of breadthFirstSearch(rootAirportCode)
+        std::vector<std::vector<VertexId>> breadthFirstSearch(VertexId root, ThreadPool& pool) const; //Parallel version of breadthFirstSearch(root)
 
-        std::vector<std::string> findShortestLandmarkPath(const std::vector<std::string>& airportCodeVector); //Takes in a vector where the first code is the origin, the last code is the final destination, and the middle code is the intermediate landmark - the function returns the shortest path from the origin to the destination through the landmark
+        //Weakly connected components (routes are followed in either direction) labeled with a lock-free union-find over the CSR edges (https://en.wikipedia.org/wiki/Disjoint-set_data_structure)
+        //Unlike breadthFirstSearch, no traversal order is built, and the labels do not depend on the number of threads
+        ComponentLabels components() const; //Labels the components on the calling thread
+        ComponentLabels components(ThreadPool& pool) const; //Labels the components with the edges split into tasks on the pool
+
+        //Strongly connected components (airports that can all reach each other), so a destination in another component than the origin may be unreachable and one in the same component never is
+        //Both versions return the same labels, and neither recurses, so the depth of the graph does not matter
+        ComponentLabels stronglyConnectedComponents() const; //Iterative Tarjan's algorithm on the calling thread (https://en.wikipedia.org/wiki/Tarjan%27s_strongly_connected_components_algorithm)
+        ComponentLabels stronglyConnectedComponents(ThreadPool& pool) const; //Parallel trimming and forward-backward search (https://doi.org/10.1007/3-540-45591-4_68)
+
+        std::vector<VertexId> findShortestPath(VertexId origin, VertexId destination, ShortestPathAlgorithm algorithm = ShortestPathAlgorithm::Dijkstra) const; //Vertex ID version of findShortestPath(originAirportCode, destinationAirportCode, algorithm), which uses the calling thread's search context (Dijkstra queries read the path from the cached tree of the origin if a tree fits in shortestPathTreeCache)
+        void findShortestPath(VertexId origin, VertexId destination, SearchContext& context, std::vector<VertexId>& shortestPath) const; //Writes the shortest path into shortestPath (reusing its memory) - afterwards, context.getDistance(destination) is the length of the path
+        double findShortestPathAStar(VertexId origin, VertexId destination, SearchContext& context, std::vector<VertexId>& shortestPath) const; //A* search with the great-circle lower bound - writes the shortest path into shortestPath and returns its length (std::numeric_limits<double>::max() if the destination is unreachable)
+        double findShortestPathBidirectional(VertexId origin, VertexId destination, SearchContext& forwardContext, SearchContext& backwardContext, std::vector<VertexId>& shortestPath) const; //Bidirectional Dijkstra - writes the shortest path into shortestPath and returns its length (std::numeric_limits<double>::max() if the destination is unreachable)
+        double findShortestPathALT(VertexId origin, VertexId destination, SearchContext& context, std::vector<VertexId>& shortestPath) const; //ALT search - writes the shortest path into shortestPath and returns its length (std::numeric_limits<double>::max() if the destination is unreachable)
+        std::vector<VertexId> findShortestLandmarkPath(const std::vector<VertexId>& vertexVector, WaypointOrder order = WaypointOrder::Given) const; //Vertex ID version of findShortestLandmarkPath(airportCodeVector, order)
+        std::vector<VertexId> findWaypointOrder(const std::vector<VertexId>& vertexVector) const; //Returns vertexVector with its middle vertices reordered to minimize the total distance from the first vertex to the last one (legs to unreachable vertices are avoided whenever possible) - exact for up to maxExactWaypointCount middle vertices, and a local optimum (2-opt and Or-opt) beyond that
+        static constexpr size_t maxExactWaypointCount = 15; //Held-Karp uses O(2^n * n) memory and O(2^n * n^2) time for n middle vertices
+
+        //Batch queries, which group the queries by origin so that each distinct origin is searched once (the search stops when all of its destinations are settled)
+        //The groups run as tasks on the pool with one search context per worker, and the paths are identical to those of findShortestPath
+        std::vector<std::vector<std::string>> findShortestPaths(const std::vector<std::pair<std::string, std::string>>& queries, ThreadPool& pool) const; //Returns the shortest path of every (origin, destination) query in input order, in the same shape as findShortestPath (throws std::out_of_range for an unknown airport code)
+        std::vector<std::vector<VertexId>> findShortestPaths(const std::vector<std::pair<VertexId, VertexId>>& queries, ThreadPool& pool) const; //Vertex ID version of findShortestPaths(queries, pool)
+
+        //Many-to-many distances, computed with one search per distinct source that stops when every target is settled (the searches run as tasks on the pool)
+        //The result is a contiguous row-major matrix, where the distance from sources[i] to targets[j] is at index i * targets.size() + j (std::numeric_limits<double>::max() if it is unreachable)
+        std::vector<double> distanceMatrix(const std::vector<std::string>& sourceAirportCodes, const std::vector<std::string>& targetAirportCodes, ThreadPool& pool) const; //Throws std::out_of_range for an unknown airport code
+        std::vector<double> distanceMatrix(const std::vector<VertexId>& sources, const std::vector<VertexId>& targets, ThreadPool& pool) const; //Vertex ID version of distanceMatrix(sourceAirportCodes, targetAirportCodes, pool)
+
+        ShortestPathTree findShortestPathTree(const std::string& originAirportCode) const; //Returns the shortest path tree of an airport (throws std::out_of_range if the code is not in the graph)
+        ShortestPathTree findShortestPathTree(VertexId origin) const; //Vertex ID version of findShortestPathTree(originAirportCode), which uses the calling thread's search context
+        void findShortestPathTree(VertexId origin, SearchContext& context, ShortestPathTree& tree) const; //Writes the shortest path tree of origin into tree (reusing its memory) - its paths are identical to those of findShortestPath
+        std::shared_ptr<const ShortestPathTree> getShortestPathTree(VertexId origin) const; //Returns the shortest path tree of origin from shortestPathTreeCache, searching and caching it on a miss
+
+        void findAllShortestDistances(VertexId source, bool reverse, SearchContext& context, std::vector<VertexId>& settledOrder) const; //Runs Dijkstra from source until every reachable vertex is settled (over the incoming edges if reverse is true, which gives distances to source) - settledOrder lists the reachable vertices in settled order
+
+        //ALT (A*, landmarks, and triangle inequality) preprocessing (https://www.microsoft.com/en-us/research/publication/computing-the-shortest-path-a-search-meets-graph-theory/)
+        //For a landmark L, the triangle inequality gives d(v, t) >= d(L, t) - d(L, v) and d(v, t) >= d(v, L) - d(t, L), which are lower bounds for A*
+        void preprocessLandmarks(size_t landmarkCount, LandmarkSelection selection = LandmarkSelection::Avoid); //Chooses landmarkCount landmarks and computes the distances from and to each of them (replaces any previous landmarks)
+        bool saveLandmarks(const std::string& filepath) const; //Writes the landmarks and their distances to a binary file - returns false if the file could not be written
+        bool loadLandmarks(const std::string& filepath); //Reads landmarks written by saveLandmarks - returns false (and keeps the current landmarks) if the file is missing, corrupt, or was written for a different graph (checked with getGraphChecksum)
+        double getLandmarkLowerBound(VertexId vertex, VertexId destination) const; //Returns the best landmark lower bound on the distance from vertex to destination (0 if there are no landmarks)
+
+        //Shortest path trees reused by findShortestPath and findShortestLandmarkPath, which pays off when queries share origins, such as itineraries through popular hubs
+        //A miss settles every reachable airport while a single query stops at its destination, so the default budget is small, and setMemoryBudget(0) disables the cache for one-off queries
+        mutable ShortestPathTreeCache shortestPathTreeCache;
 
         std::map<std::string, std::pair<double, double>> airportCodeToLatitudeLongitudeMap; //Map from an airport's code to its coordinates, which is incomplete due to the incomplete database (see notes above)
 
         std::map<std::string, int> airportCodeMap; //Map from an airport's code to its index in aiportCodeList (ordered map was used for testing purposes)
         std::vector<std::string> airportCodeList; //List of all airport codes
+        std::vector<AirportCode> airportCodes; //Packed code of each airport (same order as airportCodeList, so it is sorted)
+        std::vector<VertexId> iataVertexIds; //Direct lookup table from 3-letter uppercase codes to vertex IDs, indexed by the code read as a base-26 number (invalidVertexId if the code is not in the graph)
 
         std::set<std::pair<std::string, std::string>> edgeSet; //Set of edges (airport code to airport code)
         std::vector<std::pair<std::string, std::string>> edgeList; //List of edges (airport code to airport code)
 
-        //Adjacency matrix is formatted such that you access data using adjacencyMatrix.at(origin).at(destination)
-        //If the value is postive, the edge exists
-        //If the value is negative, the edge does not exist
-        //There should be no zero values
-        //The magnitude of positve values represents the number of kilometers between airports
-        std::vector<std::vector<double>> adjacencyMatrix;
+        //Compressed sparse row (CSR) adjacency structure
+        //The outgoing edges of the airport at index i occupy positions [adjacencyOffsets.at(i), adjacencyOffsets.at(i + 1)) of adjacencyTargets and adjacencyWeights
+        //Targets within a row are sorted by index (i.e., alphabetically by airport code)
+        //Weights are the number of kilometers between airports and are always positive
+        //Routes whose airports have identical coordinates (e.g., two airports without a known coordinate) have no positive distance, so they are not stored
+        std::vector<size_t> adjacencyOffsets; //Size is airportCodeList.size() + 1
+        std::vector<VertexId> adjacencyTargets; //Vertex ID (index) of the destination airport of each edge
+        std::vector<double> adjacencyWeights; //Distance of each edge in kilometers
+
+        std::vector<double> unitSphereVectors; //Position of each airport on the unit sphere, stored as x, y, z at indices 3 * i to 3 * i + 2 (used by the A* heuristic)
+
+        //Reverse CSR adjacency structure, which stores the same edges grouped by destination (used by backward searches)
+        //The incoming edges of the airport at index i occupy positions [reverseAdjacencyOffsets.at(i), reverseAdjacencyOffsets.at(i + 1)) of reverseAdjacencyTargets and reverseAdjacencyWeights
+        std::vector<size_t> reverseAdjacencyOffsets; //Size is airportCodeList.size() + 1
+        std::vector<VertexId> reverseAdjacencyTargets; //Vertex ID of the origin airport of each edge (sorted within a row)
+        std::vector<double> reverseAdjacencyWeights; //Distance of each edge in kilometers
+
+        //ALT landmarks and their distances, stored vertex-major so that the bounds of one vertex are contiguous
+        //Unreachable distances are infinite
+        std::vector<VertexId> landmarks; //Vertex IDs of the landmarks
+        std::vector<double> landmarkDistancesFrom; //Distance from landmark i to vertex v at index v * landmarks.size() + i
+        std::vector<double> landmarkDistancesTo; //Distance from vertex v to landmark i at index v * landmarks.size() + i
+
+    private:
+        static constexpr size_t iataTableSize = 26 * 26 * 26; //Number of 3-letter uppercase codes
+        static constexpr double unreachableLegCost = 1e12; //Cost of an unreachable waypoint leg, which is more than any tour of reachable legs, so an order with fewer unreachable legs always wins and the sums stay finite
+
+        static size_t getIataIndex(AirportCode airportCode); //Returns the index of a 3-letter uppercase code in iataVertexIds (iataTableSize for any other code)
+        void buildIataTable(); //Assigns iataVertexIds from airportCodes
+
+        void findDistanceRow(VertexId source, const std::vector<VertexId>& sortedTargets, const std::vector<VertexId>& targets, SearchContext& context, double* row) const; //Writes the distances from source to targets into row, where sortedTargets holds the distinct targets in order
+        std::vector<double> getWaypointDistances(const std::vector<VertexId>& vertexVector) const; //Returns the shortest distances between the given vertices as a row-major matrix (one early-stopping search per distinct vertex on the calling thread), where unreachable pairs cost unreachableLegCost
+        static std::vector<size_t> findExactWaypointOrder(const std::vector<double>& distances, size_t count); //Held-Karp over the distance matrix of count vertices with fixed first and last vertices - returns the visiting order as matrix indices
+        static void improveWaypointOrder(const std::vector<double>& distances, std::vector<size_t>& order); //Applies improving 2-opt and Or-opt moves to the middle of order until none is left
+
+        struct BreadthFirstSearchState { //Buffers shared by the breadth-first searches of one traversal
+            std::vector<std::uint64_t> visited; //Bitmap of the visited vertices
+            std::vector<std::uint64_t> frontier; //Bitmap of the vertices of the current level (only used by bottom-up steps)
+            std::vector<VertexId> frontierPositions; //Position of each vertex of the current level within the level (only valid for the vertices in frontier)
+            std::vector<std::pair<VertexId, VertexId>> discovered; //(parent position, vertex) pairs found by a bottom-up step
+            std::vector<size_t> positionCounts; //Counting sort buffer of a bottom-up step
+            size_t unvisitedEdgeCount; //Number of incoming edges of the unvisited vertices, which is the work of a bottom-up step
+        };
+
+        void initializeBreadthFirstSearch(BreadthFirstSearchState& state) const; //Sizes the buffers with every vertex unvisited
+        void breadthFirstSearch(VertexId root, BreadthFirstSearchState& state, std::vector<VertexId>& traversal) const; //Appends the vertices reachable from root that are not visited yet to traversal in breadth-first order (root is always included)
+        void expandBottomUp(BreadthFirstSearchState& state, std::vector<VertexId>& traversal, size_t levelBegin, size_t levelEnd) const; //Appends the next level after traversal[levelBegin, levelEnd) by scanning the incoming edges of the unvisited vertices
+
+        struct ParallelBreadthFirstSearchState { //Buffers shared by the parallel breadth-first searches of one traversal
+            std::unique_ptr<std::atomic<std::uint64_t>[]> visited; //Bitmap of the visited vertices
+            std::unique_ptr<std::atomic<VertexId>[]> parentPositions; //Smallest position of a frontier vertex with an edge to the vertex (invalidVertexId if no frontier vertex reached it yet, and only meaningful for unvisited vertices)
+            std::vector<std::uint64_t> frontier; //Bitmap of the vertices of the current level (only used by bottom-up steps)
+            std::vector<VertexId> frontierPositions; //Position of each vertex of the current level within the level (only valid for the vertices in frontier)
+            std::vector<std::vector<VertexId>> chunkLevels; //Part of the next level found by each chunk, in order
+            std::vector<size_t> chunkOffsets; //Position of each chunk's part within the next level
+            std::vector<size_t> positionCounts; //Counting sort buffer of a bottom-up step
+            size_t unvisitedEdgeCount; //Number of incoming edges of the unvisited vertices, which is the work of a bottom-up step
+        };
+
+        void breadthFirstSearch(VertexId root, ParallelBreadthFirstSearchState& state, ThreadPool& pool, std::vector<VertexId>& traversal) const; //Appends the vertices reachable from root that are not visited yet to traversal in breadth-first order
+
+        static ComponentLabels labelByRepresentative(const std::vector<VertexId>& representatives); //Numbers the components given one representative vertex of each vertex's component
+        void markReachable(VertexId pivot, VertexId partition, bool reverse, std::uint8_t mark, std::atomic<VertexId>* partitions, std::atomic<std::uint8_t>* marks, ThreadPool& pool) const; //Sets mark on every vertex of partition reachable from pivot within the partition (over the incoming edges if reverse is true), expanding large levels as tasks on the pool
+
+        void uniteComponents(VertexId first, VertexId last, std::atomic<VertexId>* parents) const; //Unites the endpoints of the outgoing edges of the vertices in [first, last) (safe to run concurrently on the same parents)
+        ComponentLabels labelComponents(std::atomic<VertexId>* parents) const; //Numbers the sets of parents once every edge is united
+
+        template <typename LowerBound, typename OnSettle>
+        void runDijkstra(VertexId source, bool reverse, SearchContext& context, const LowerBound& lowerBound, const OnSettle& onSettle) const; //Dijkstra core of the one-to-one, one-to-many, and one-to-all searches (over the incoming edges if reverse is true), where heap keys add lowerBound(vertex) and the search stops once onSettle(vertex) returns true
+        void settleDestinations(VertexId origin, const std::vector<VertexId>& destinations, SearchContext& context) const; //Runs Dijkstra from origin until every vertex of destinations (sorted, without duplicates) is settled or the reachable vertices run out
+        void extractPath(VertexId origin, VertexId destination, const SearchContext& context, std::vector<VertexId>& shortestPath) const; //Writes the path to destination given by the predecessors in context (only the destination if it is unreachable)
+
+        template <typename LowerBound>
+        double findShortestPathGuided(VertexId origin, VertexId destination, SearchContext& context, std::vector<VertexId>& shortestPath, const LowerBound& lowerBound) const; //A* shared by findShortestPathAStar and findShortestPathALT, where lowerBound(vertex) bounds the distance from vertex to destination
+
+        double getLandmarkLowerBound(VertexId vertex, const double* destinationFrom, const double* destinationTo) const; //Landmark lower bound given the destination's rows of landmarkDistancesFrom and landmarkDistancesTo
 };
@@ -0,0 +1,247 @@
+#include "HubLabels.h"
+
+namespace {
+    typedef std::vector<std::pair<FlightGraph::VertexId, double>> Label; //(hub, distance) entries sorted by hub
+
+    //Merges two labels sorted by hub and returns the minimum distance over their common hubs (also writes the hub that gives it)
+    double mergeLabels(const FlightGraph::VertexId* firstHubs, const double* firstDistances, size_t firstSize, const FlightGraph::VertexId* secondHubs, const double* secondDistances, size_t secondSize, FlightGraph::VertexId& bestHub) {
+        double bestDistance = std::numeric_limits<double>::max();
+        bestHub = FlightGraph::invalidVertexId;
+        size_t i = 0;
+        size_t j = 0;
+        while (i < firstSize && j < secondSize) {
+            if (firstHubs[i] < secondHubs[j]) {
+                ++i;
+            } else if (secondHubs[j] < firstHubs[i]) {
+                ++j;
+            } else {
+                if (firstDistances[i] + secondDistances[j] < bestDistance) {
+                    bestDistance = firstDistances[i] + secondDistances[j];
+                    bestHub = firstHubs[i];
+                }
+                ++i;
+                ++j;
+            }
+        }
+        return bestDistance;
+    }
+
+    double mergeLabels(const Label& first, const Label& second) {
+        double bestDistance = std::numeric_limits<double>::max();
+        size_t i = 0;
+        size_t j = 0;
+        while (i < first.size() && j < second.size()) {
+            if (first.at(i).first < second.at(j).first) {
+                ++i;
+            } else if (second.at(j).first < first.at(i).first) {
+                ++j;
+            } else {
+                bestDistance = std::min(bestDistance, first.at(i).second + second.at(j).second);
+                ++i;
+                ++j;
+            }
+        }
+        return bestDistance;
+    }
+
+    //Builds the label of vertex from the labels of its upward neighbors, which are all more important and therefore already built
+    //otherLabels are the labels of the opposite direction, which are used to prune entries whose distance is not a shortest distance
+    void buildLabel(FlightGraph::VertexId vertex, const std::vector<size_t>& offsets, const std::vector<FlightGraph::VertexId>& targets, const std::vector<double>& weights, std::vector<Label>& labels, const std::vector<Label>& otherLabels, std::vector<double>& candidateDistances, std::vector<FlightGraph::VertexId>& touchedHubs) {
+        touchedHubs.clear();
+        candidateDistances.at(vertex) = 0.0;
+        touchedHubs.push_back(vertex);
+        for (size_t i = offsets.at(vertex); i < offsets.at(vertex + 1); ++i) {
+            for (const std::pair<FlightGraph::VertexId, double>& entry : labels.at(targets.at(i))) {
+                double distance = weights.at(i) + entry.second;
+                if (candidateDistances.at(entry.first) == std::numeric_limits<double>::max()) {
+                    touchedHubs.push_back(entry.first);
+                }
+                candidateDistances.at(entry.first) = std::min(candidateDistances.at(entry.first), distance);
+            }
+        }
+
+        Label candidateLabel;
+        std::sort(touchedHubs.begin(), touchedHubs.end());
+        for (FlightGraph::VertexId hub : touchedHubs) {
+            candidateLabel.push_back(std::make_pair(hub, candidateDistances.at(hub)));
+            candidateDistances.at(hub) = std::numeric_limits<double>::max();
+        }
+
+        Label& label = labels.at(vertex);
+        for (const std::pair<FlightGraph::VertexId, double>& entry : candidateLabel) {
+            if (entry.first == vertex || !(mergeLabels(candidateLabel, otherLabels.at(entry.first)) < entry.second)) {
+                label.push_back(entry);
+            }
+        }
+    }
+
+    //Converts per-vertex labels into CSR arrays
+    void flattenLabels(const std::vector<Label>& labels, std::vector<size_t>& offsets, std::vector<FlightGraph::VertexId>& hubs, std::vector<double>& distances) {
+        offsets = std::vector<size_t>(labels.size() + 1, 0);
+        for (size_t vertex = 0; vertex < labels.size(); ++vertex) {
+            offsets.at(vertex + 1) = offsets.at(vertex) + labels.at(vertex).size();
+            for (const std::pair<FlightGraph::VertexId, double>& entry : labels.at(vertex)) {
+                hubs.push_back(entry.first);
+                distances.push_back(entry.second);
+            }
+        }
+    }
+
+    template <typename T>
+    void writeVector(std::ofstream& file, const std::vector<T>& values) {
+        std::uint64_t size = values.size();
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    //Reads a vector written by writeVector, rejecting a size above maxSize or beyond the end of the file before anything is allocated
+    template <typename T>
+    bool readVector(std::ifstream& file, std::vector<T>& values, std::uint64_t maxSize) {
+        std::uint64_t size = 0;
+        file.read(reinterpret_cast<char*>(&size), sizeof(size));
+        if (!file) {
+            return false;
+        }
+        std::streampos position = file.tellg();
+        file.seekg(0, std::ios::end);
+        std::uint64_t remainingBytes = file.tellg() - position;
+        file.seekg(position);
+        if (size > maxSize || size > remainingBytes / sizeof(T)) {
+            return false;
+        }
+        values = std::vector<T>(size);
+        file.read(reinterpret_cast<char*>(values.data()), size * sizeof(T));
+        return (bool) file;
+    }
+
+    //Checks that offsets describe rows of hubs that are valid and sorted
+    bool isValidLabeling(const std::vector<size_t>& offsets, const std::vector<FlightGraph::VertexId>& hubs, const std::vector<double>& distances, size_t vertexCount) {
+        if (offsets.size() != vertexCount + 1 || offsets.front() != 0 || offsets.back() != hubs.size() || hubs.size() != distances.size()) {
+            return false;
+        }
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+            if (offsets.at(vertex) > offsets.at(vertex + 1)) {
+                return false;
+            }
+            for (size_t i = offsets.at(vertex); i < offsets.at(vertex + 1); ++i) {
+                if (hubs.at(i) >= vertexCount || (i > offsets.at(vertex) && hubs.at(i - 1) >= hubs.at(i))) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+HubLabels::HubLabels(const FlightGraph& graph, const ContractionHierarchy& hierarchy) : graph(&graph) {
+    size_t vertexCount = graph.getVertexCount();
+    std::vector<VertexId> order(vertexCount); //Vertices by rank
+    for (VertexId vertex = 0; vertex < vertexCount; ++vertex) {
+        order.at(hierarchy.rank.at(vertex)) = vertex;
+    }
+
+    std::vector<Label> forwardLabels(vertexCount);
+    std::vector<Label> backwardLabels(vertexCount);
+    std::vector<double> candidateDistances(vertexCount, std::numeric_limits<double>::max());
+    std::vector<VertexId> touchedHubs;
+    for (size_t i = vertexCount; i-- > 0;) { //Most important vertex first
+        VertexId vertex = order.at(i);
+        buildLabel(vertex, hierarchy.forwardOffsets, hierarchy.forwardTargets, hierarchy.forwardWeights, forwardLabels, backwardLabels, candidateDistances, touchedHubs);
+        buildLabel(vertex, hierarchy.backwardOffsets, hierarchy.backwardTargets, hierarchy.backwardWeights, backwardLabels, forwardLabels, candidateDistances, touchedHubs);
+    }
+
+    flattenLabels(forwardLabels, forwardLabelOffsets, forwardLabelHubs, forwardLabelDistances);
+    flattenLabels(backwardLabels, backwardLabelOffsets, backwardLabelHubs, backwardLabelDistances);
+}
+
+HubLabels::HubLabels(const FlightGraph& graph) : graph(&graph) {
+    forwardLabelOffsets = std::vector<size_t>(graph.getVertexCount() + 1, 0);
+    backwardLabelOffsets = std::vector<size_t>(graph.getVertexCount() + 1, 0);
+}
+
+double HubLabels::getDistance(const std::string& originAirportCode, const std::string& destinationAirportCode) const {
+    return getDistance(graph->getVertexId(originAirportCode), graph->getVertexId(destinationAirportCode));
+}
+
+double HubLabels::getDistance(VertexId origin, VertexId destination) const {
+    VertexId hub = FlightGraph::invalidVertexId;
+    size_t forwardFirst = forwardLabelOffsets[origin];
+    size_t backwardFirst = backwardLabelOffsets[destination];
+    return mergeLabels(forwardLabelHubs.data() + forwardFirst, forwardLabelDistances.data() + forwardFirst, forwardLabelOffsets[origin + 1] - forwardFirst, backwardLabelHubs.data() + backwardFirst, backwardLabelDistances.data() + backwardFirst, backwardLabelOffsets[destination + 1] - backwardFirst, hub);
+}
+
+HubLabels::VertexId HubLabels::getHub(VertexId origin, VertexId destination) const {
+    VertexId hub = FlightGraph::invalidVertexId;
+    size_t forwardFirst = forwardLabelOffsets[origin];
+    size_t backwardFirst = backwardLabelOffsets[destination];
+    mergeLabels(forwardLabelHubs.data() + forwardFirst, forwardLabelDistances.data() + forwardFirst, forwardLabelOffsets[origin + 1] - forwardFirst, backwardLabelHubs.data() + backwardFirst, backwardLabelDistances.data() + backwardFirst, backwardLabelOffsets[destination + 1] - backwardFirst, hub);
+    return hub;
+}
+
+size_t HubLabels::getEntryCount() const {
+    return forwardLabelHubs.size() + backwardLabelHubs.size();
+}
+
+//File format: "FGHUB" magic, format version, vertex count, graph checksum, and then the six label arrays (each prefixed by its size)
+bool HubLabels::save(const std::string& filepath) const {
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::uint32_t version = 2;
+    std::uint64_t vertexCount = graph->getVertexCount();
+    std::uint64_t checksum = graph->getGraphChecksum();
+    file.write("FGHUB", 5);
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char*>(&vertexCount), sizeof(vertexCount));
+    file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+    writeVector(file, forwardLabelOffsets);
+    writeVector(file, forwardLabelHubs);
+    writeVector(file, forwardLabelDistances);
+    writeVector(file, backwardLabelOffsets);
+    writeVector(file, backwardLabelHubs);
+    writeVector(file, backwardLabelDistances);
+    return (bool) file;
+}
+
+bool HubLabels::load(const std::string& filepath) {
+    std::ifstream file(filepath, std::ios::binary);
+    char magic[5];
+    std::uint32_t version = 0;
+    std::uint64_t vertexCount = 0;
+    std::uint64_t checksum = 0;
+    file.read(magic, 5);
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&vertexCount), sizeof(vertexCount));
+    file.read(reinterpret_cast<char*>(&checksum), sizeof(checksum));
+    if (!file || std::string(magic, 5) != "FGHUB" || version != 2 || vertexCount != graph->getVertexCount() || checksum != graph->getGraphChecksum()) {
+        return false;
+    }
+
+    std::vector<size_t> newForwardOffsets;
+    std::vector<VertexId> newForwardHubs;
+    std::vector<double> newForwardDistances;
+    std::vector<size_t> newBackwardOffsets;
+    std::vector<VertexId> newBackwardHubs;
+    std::vector<double> newBackwardDistances;
+    //The last offset of a labeling is its entry count, so hubs and distances are bounded by it
+    if (!readVector(file, newForwardOffsets, vertexCount + 1) || newForwardOffsets.size() != vertexCount + 1
+        || !readVector(file, newForwardHubs, newForwardOffsets.back()) || !readVector(file, newForwardDistances, newForwardOffsets.back())) {
+        return false;
+    }
+    if (!readVector(file, newBackwardOffsets, vertexCount + 1) || newBackwardOffsets.size() != vertexCount + 1
+        || !readVector(file, newBackwardHubs, newBackwardOffsets.back()) || !readVector(file, newBackwardDistances, newBackwardOffsets.back())) {
+        return false;
+    }
+    if (!isValidLabeling(newForwardOffsets, newForwardHubs, newForwardDistances, vertexCount) || !isValidLabeling(newBackwardOffsets, newBackwardHubs, newBackwardDistances, vertexCount)) {
+        return false;
+    }
+
+    forwardLabelOffsets = newForwardOffsets;
+    forwardLabelHubs = newForwardHubs;
+    forwardLabelDistances = newForwardDistances;
+    backwardLabelOffsets = newBackwardOffsets;
+    backwardLabelHubs = newBackwardHubs;
+    backwardLabelDistances = newBackwardDistances;
+    return true;
+}
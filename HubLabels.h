@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FlightGraph.h"
+#include "ContractionHierarchy.h"
+
+/*
+Notes:
+Hub labeling (a 2-hop cover) built from a contraction hierarchy (https://www.microsoft.com/en-us/research/publication/hierarchical-hub-labelings-for-shortest-paths/)
+
+Every airport gets a forward label (hubs it can reach, with distances) and a backward label (hubs that can reach it, with distances)
+For any origin and destination, the most important airport on a shortest path is in both labels, so the distance is the minimum of forward(origin, h) + backward(destination, h) over the common hubs h
+Labels are sorted by hub, so a query is a merge of two sorted arrays and does not touch the graph
+
+Labels are built from the most important airport down, and an entry is pruned if the labels built so far already prove a shorter path to its hub
+
+The labels keep a pointer to the graph, so the graph must outlive them
+*/
+
+class HubLabels {
+    public:
+        typedef FlightGraph::VertexId VertexId;
+
+        HubLabels(const FlightGraph& graph, const ContractionHierarchy& hierarchy); //Builds the labels from the hierarchy's contraction order and upward search graphs
+        HubLabels(const FlightGraph& graph); //Creates empty labels (every destination is unreachable) to be filled by load
+
+        double getDistance(const std::string& originAirportCode, const std::string& destinationAirportCode) const; //Returns the length of the shortest path (std::numeric_limits<double>::max() if the destination is unreachable)
+        double getDistance(VertexId origin, VertexId destination) const; //Vertex ID version of getDistance(originAirportCode, destinationAirportCode)
+        VertexId getHub(VertexId origin, VertexId destination) const; //Returns the common hub that gives the distance (FlightGraph::invalidVertexId if the destination is unreachable)
+
+        size_t getEntryCount() const; //Returns the total number of label entries (forward and backward)
+
+        bool save(const std::string& filepath) const; //Writes the labels to a binary file - returns false if the file could not be written
+        bool load(const std::string& filepath); //Reads labels written by save - returns false (and keeps the current labels) if the file is missing, corrupt, or was written for a different graph (checked with FlightGraph::getGraphChecksum, which also covers edge weights)
+
+        //Labels in CSR form (see FlightGraph for the CSR layout), where each row is sorted by hub
+        std::vector<size_t> forwardLabelOffsets;
+        std::vector<VertexId> forwardLabelHubs;
+        std::vector<double> forwardLabelDistances; //Distance from the vertex to the hub
+
+        std::vector<size_t> backwardLabelOffsets;
+        std::vector<VertexId> backwardLabelHubs;
+        std::vector<double> backwardLabelDistances; //Distance from the hub to the vertex
+
+    private:
+        const FlightGraph* graph;
+};
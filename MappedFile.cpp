@@ -0,0 +1,49 @@
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& filepath) : contents(nullptr), length(0), isMapped(false), opened(false) {
+    int descriptor = open(filepath.c_str(), O_RDONLY);
+    if (descriptor >= 0) {
+        opened = true;
+        struct stat status;
+        if (fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0) {
+            void* mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (mapping != MAP_FAILED) {
+                contents = static_cast<const char*>(mapping);
+                length = status.st_size;
+                isMapped = true;
+                madvise(mapping, length, MADV_SEQUENTIAL); //The parsers read the file front to back
+            }
+        }
+        close(descriptor); //The mapping stays valid after the descriptor is closed
+    }
+
+    if (opened && !isMapped) {
+        std::ifstream file(filepath, std::ios::binary);
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        contents = buffer.data();
+        length = buffer.size();
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (isMapped) {
+        munmap(const_cast<char*>(contents), length);
+    }
+}
+
+const char* MappedFile::data() const {
+    return contents;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
+
+bool MappedFile::isOpen() const {
+    return opened;
+}
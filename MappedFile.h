@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+/*
+Notes:
+MappedFile maps a whole file read-only into memory (https://man7.org/linux/man-pages/man2/mmap.2.html), so parsers can read it in place without copying it into strings
+
+If the file cannot be mapped (e.g., it is empty or is not a regular file), its contents are read into a buffer instead
+A missing file behaves like an empty file, which matches how std::ifstream was used before
+
+The mapping is released by the destructor, so views into data() must not outlive the MappedFile
+*/
+
+class MappedFile {
+    public:
+        MappedFile(const std::string& filepath); //Maps the file (or reads it into a buffer if mapping fails)
+        ~MappedFile(); //Unmaps the file
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* data() const; //Returns the first byte of the file
+        size_t size() const; //Returns the number of bytes in the file
+        bool isOpen() const; //Returns whether the file could be opened
+
+    private:
+        const char* contents;
+        size_t length;
+        bool isMapped; //Whether contents points to a mapping (true) or into buffer (false)
+        bool opened;
+        std::vector<char> buffer; //Fallback storage when the file cannot be mapped
+};
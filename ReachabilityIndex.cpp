@@ -0,0 +1,228 @@
+#include "ReachabilityIndex.h"
+
+#include <algorithm>
+
+namespace {
+    //Visit stamps of the fallback search, kept per thread so that const queries can run concurrently
+    struct ComponentStamps {
+        std::vector<std::uint32_t> stamps;
+        std::uint32_t currentStamp = 0;
+
+        //Starts a search over componentCount components, where a component is visited once its stamp equals currentStamp
+        void reset(size_t componentCount) {
+            if (stamps.size() < componentCount) {
+                stamps.resize(componentCount, 0);
+            }
+            if (++currentStamp == 0) { //Wrapped around, so old stamps could look current
+                std::fill(stamps.begin(), stamps.end(), 0);
+                currentStamp = 1;
+            }
+        }
+    };
+
+    ComponentStamps& getThreadComponentStamps() {
+        thread_local ComponentStamps stamps;
+        return stamps;
+    }
+}
+
+ReachabilityIndex::ReachabilityIndex(const FlightGraph& graph, size_t maxClosureBytes) : graph(&graph), closureWordCount(0) {
+    const FlightGraph::ComponentLabels& labels = graph.stronglyConnectedComponents();
+    componentIds = labels.componentIds;
+    size_t componentCount = labels.componentSizes.size();
+
+    //Edges between components, deduplicated per row
+    dagOffsets = std::vector<size_t>(componentCount + 1, 0);
+    for (VertexId vertex = 0; vertex < graph.getVertexCount(); ++vertex) {
+        for (VertexId target : graph.neighbors(vertex)) {
+            if (componentIds[vertex] != componentIds[target]) {
+                ++dagOffsets[componentIds[vertex] + 1];
+            }
+        }
+    }
+    for (size_t component = 0; component < componentCount; ++component) {
+        dagOffsets[component + 1] += dagOffsets[component];
+    }
+    dagTargets = std::vector<VertexId>(dagOffsets.back());
+    std::vector<size_t> positions(dagOffsets.begin(), dagOffsets.end() - 1);
+    for (VertexId vertex = 0; vertex < graph.getVertexCount(); ++vertex) {
+        for (VertexId target : graph.neighbors(vertex)) {
+            if (componentIds[vertex] != componentIds[target]) {
+                dagTargets[positions[componentIds[vertex]]++] = componentIds[target];
+            }
+        }
+    }
+    size_t edgeCount = 0;
+    for (size_t component = 0; component < componentCount; ++component) {
+        std::vector<VertexId>::iterator first = dagTargets.begin() + dagOffsets[component];
+        std::sort(first, dagTargets.begin() + dagOffsets[component + 1]);
+        std::vector<VertexId>::iterator last = std::unique(first, dagTargets.begin() + dagOffsets[component + 1]);
+        dagOffsets[component] = edgeCount;
+        edgeCount = std::copy(first, last, dagTargets.begin() + edgeCount) - dagTargets.begin();
+    }
+    dagOffsets[componentCount] = edgeCount;
+    dagTargets.resize(edgeCount);
+    dagTargets.shrink_to_fit();
+
+    //Topological order by Kahn's algorithm, whose initial queue holds the roots of the DAG
+    std::vector<size_t> inDegrees(componentCount, 0);
+    for (VertexId target : dagTargets) {
+        ++inDegrees[target];
+    }
+    std::vector<VertexId> topologicalOrder;
+    topologicalOrder.reserve(componentCount);
+    for (size_t component = 0; component < componentCount; ++component) {
+        if (inDegrees[component] == 0) {
+            topologicalOrder.push_back(component);
+        }
+    }
+    std::vector<VertexId> roots(topologicalOrder);
+    for (size_t i = 0; i < topologicalOrder.size(); ++i) {
+        VertexId component = topologicalOrder[i];
+        for (size_t j = dagOffsets[component]; j < dagOffsets[component + 1]; ++j) {
+            if (--inDegrees[dagTargets[j]] == 0) {
+                topologicalOrder.push_back(dagTargets[j]);
+            }
+        }
+    }
+    topologicalRanks = std::vector<VertexId>(componentCount);
+    for (size_t i = 0; i < componentCount; ++i) {
+        topologicalRanks[topologicalOrder[i]] = i;
+    }
+
+    size_t wordCount = (componentCount + 63) / 64;
+    if (wordCount == 0 || componentCount <= maxClosureBytes / sizeof(std::uint64_t) / wordCount) {
+        closureWordCount = wordCount;
+        buildClosure(topologicalOrder);
+    } else {
+        buildIntervalLabels(roots);
+    }
+}
+
+void ReachabilityIndex::buildClosure(const std::vector<VertexId>& topologicalOrder) {
+    closureBits = std::vector<std::uint64_t>(topologicalOrder.size() * closureWordCount, 0);
+    for (std::vector<VertexId>::const_reverse_iterator it = topologicalOrder.rbegin(); it != topologicalOrder.rend(); ++it) {
+        std::uint64_t* row = closureBits.data() + *it * closureWordCount;
+        row[*it / 64] |= std::uint64_t(1) << (*it % 64);
+        for (size_t i = dagOffsets[*it]; i < dagOffsets[*it + 1]; ++i) { //Successors come later in the order, so their rows are complete
+            const std::uint64_t* successorRow = closureBits.data() + dagTargets[i] * closureWordCount;
+            for (size_t word = 0; word < closureWordCount; ++word) {
+                row[word] |= successorRow[word];
+            }
+        }
+    }
+}
+
+//Ranks are assigned in post-order, and low is the smallest rank reachable from a component (every reachable component is finished before it)
+//Tree lows are the rank counter when a component is entered, so the tree descendants of a component are exactly the ranks [treeLow, rank]
+void ReachabilityIndex::buildIntervalLabels(const std::vector<VertexId>& roots) {
+    size_t componentCount = topologicalRanks.size();
+    intervalLows = std::vector<VertexId>(componentCount * intervalLabelCount);
+    intervalRanks = std::vector<VertexId>(componentCount * intervalLabelCount, FlightGraph::invalidVertexId);
+    treeLows = std::vector<VertexId>(componentCount);
+
+    std::vector<std::pair<VertexId, size_t>> stack; //(component, children visited so far)
+    for (size_t label = 0; label < intervalLabelCount; ++label) {
+        bool isReversed = label % 2 == 1;
+        std::vector<bool> visited(componentCount, false);
+        VertexId nextRank = 0;
+        for (size_t i = 0; i < roots.size(); ++i) {
+            VertexId root = roots[isReversed ? roots.size() - 1 - i : i];
+            visited[root] = true;
+            stack.push_back(std::make_pair(root, 0));
+            if (label == 0) {
+                treeLows[root] = nextRank;
+            }
+            while (!stack.empty()) {
+                VertexId component = stack.back().first;
+                size_t childCount = dagOffsets[component + 1] - dagOffsets[component];
+                if (stack.back().second < childCount) {
+                    size_t position = stack.back().second++;
+                    VertexId child = dagTargets[isReversed ? dagOffsets[component + 1] - 1 - position : dagOffsets[component] + position];
+                    if (!visited[child]) {
+                        visited[child] = true;
+                        stack.push_back(std::make_pair(child, 0));
+                        if (label == 0) {
+                            treeLows[child] = nextRank;
+                        }
+                    }
+                    continue;
+                }
+                stack.pop_back();
+                VertexId low = nextRank;
+                for (size_t j = dagOffsets[component]; j < dagOffsets[component + 1]; ++j) {
+                    low = std::min(low, intervalLows[dagTargets[j] * intervalLabelCount + label]);
+                }
+                intervalLows[component * intervalLabelCount + label] = low;
+                intervalRanks[component * intervalLabelCount + label] = nextRank++;
+            }
+        }
+    }
+}
+
+bool ReachabilityIndex::isReachable(const std::string& originAirportCode, const std::string& destinationAirportCode) const {
+    return isReachable(graph->getVertexId(originAirportCode), graph->getVertexId(destinationAirportCode));
+}
+
+bool ReachabilityIndex::isReachable(VertexId origin, VertexId destination) const {
+    VertexId originComponent = componentIds.at(origin);
+    VertexId destinationComponent = componentIds.at(destination);
+    if (originComponent == destinationComponent) {
+        return true;
+    }
+    if (closureWordCount > 0) {
+        return (closureBits[originComponent * closureWordCount + destinationComponent / 64] >> (destinationComponent % 64)) & 1;
+    }
+    if (topologicalRanks[originComponent] > topologicalRanks[destinationComponent] || !isLabelContained(originComponent, destinationComponent)) {
+        return false;
+    }
+    if (isTreeDescendant(originComponent, destinationComponent)) {
+        return true;
+    }
+    return searchComponents(originComponent, destinationComponent);
+}
+
+size_t ReachabilityIndex::getComponentCount() const {
+    return topologicalRanks.size();
+}
+
+bool ReachabilityIndex::hasTransitiveClosure() const {
+    return closureWordCount > 0;
+}
+
+bool ReachabilityIndex::isLabelContained(VertexId origin, VertexId destination) const {
+    for (size_t label = 0; label < intervalLabelCount; ++label) {
+        if (intervalLows[origin * intervalLabelCount + label] > intervalLows[destination * intervalLabelCount + label] || intervalRanks[origin * intervalLabelCount + label] < intervalRanks[destination * intervalLabelCount + label]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ReachabilityIndex::isTreeDescendant(VertexId origin, VertexId destination) const {
+    VertexId destinationRank = intervalRanks[destination * intervalLabelCount];
+    return treeLows[origin] <= destinationRank && destinationRank <= intervalRanks[origin * intervalLabelCount];
+}
+
+bool ReachabilityIndex::searchComponents(VertexId origin, VertexId destination) const {
+    ComponentStamps& stamps = getThreadComponentStamps();
+    stamps.reset(topologicalRanks.size());
+    std::vector<VertexId> stack {origin};
+    stamps.stamps[origin] = stamps.currentStamp;
+    while (!stack.empty()) {
+        VertexId component = stack.back();
+        stack.pop_back();
+        for (size_t i = dagOffsets[component]; i < dagOffsets[component + 1]; ++i) {
+            VertexId child = dagTargets[i];
+            if (isTreeDescendant(child, destination)) { //Also true if child is the destination
+                return true;
+            }
+            if (stamps.stamps[child] == stamps.currentStamp || topologicalRanks[child] > topologicalRanks[destination] || !isLabelContained(child, destination)) {
+                continue;
+            }
+            stamps.stamps[child] = stamps.currentStamp;
+            stack.push_back(child);
+        }
+    }
+    return false;
+}
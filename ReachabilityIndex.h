@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FlightGraph.h"
+
+/*
+Notes:
+Reachability index on the condensation of the graph (https://en.wikipedia.org/wiki/Strongly_connected_component#Definitions)
+
+Airports in the same strongly connected component reach each other, so the index only answers queries between components, which form a DAG
+Components are ranked in topological order, and a component can only reach components of a higher rank
+
+If the transitive closure of the DAG fits in maxClosureBytes, every component stores a bitset of the components it reaches (built in reverse topological order, one word OR per 64 components), and a query is one bit test
+Otherwise every component stores interval labels from depth-first traversals of the DAG (https://doi.org/10.14778/1920841.1920879):
+    A post-order interval [low, rank] contains the interval of every component it reaches, so a query is rejected if any of its labels is not contained
+    The first traversal's spanning tree intervals are exact, so a query is accepted if the destination is a tree descendant of the origin
+    The remaining queries fall back to a depth-first search of the DAG that is pruned by the same tests, which is rarely needed in practice
+
+The index keeps a pointer to the graph, so the graph must outlive it
+*/
+
+class ReachabilityIndex {
+    public:
+        typedef FlightGraph::VertexId VertexId;
+
+        ReachabilityIndex(const FlightGraph& graph, size_t maxClosureBytes = 64 << 20); //Builds the index, with a transitive closure if it fits in maxClosureBytes and interval labels otherwise
+
+        bool isReachable(const std::string& originAirportCode, const std::string& destinationAirportCode) const; //Returns true if there is a path from the origin to the destination (every airport reaches itself)
+        bool isReachable(VertexId origin, VertexId destination) const; //Vertex ID version of isReachable(originAirportCode, destinationAirportCode)
+
+        size_t getComponentCount() const; //Returns the number of strongly connected components
+        bool hasTransitiveClosure() const; //Returns true if queries are bit tests on the transitive closure rather than interval label tests
+
+        static constexpr size_t intervalLabelCount = 2; //Traversals used for interval labels (children in the given order, then in reverse order)
+
+    private:
+        const FlightGraph* graph;
+
+        std::vector<VertexId> componentIds; //Strongly connected component of each vertex
+        std::vector<VertexId> topologicalRanks; //Position of each component in a topological order of the DAG
+
+        //DAG of the components in CSR form (see FlightGraph for the CSR layout), without duplicate edges
+        std::vector<size_t> dagOffsets;
+        std::vector<VertexId> dagTargets;
+
+        size_t closureWordCount; //Words per row of closureBits (0 if the closure is not stored)
+        std::vector<std::uint64_t> closureBits; //Row of each component, where bit d is set if the component reaches component d
+
+        //Interval labels, where label i of component c is [intervalLows[c * intervalLabelCount + i], intervalRanks[c * intervalLabelCount + i]]
+        std::vector<VertexId> intervalLows;
+        std::vector<VertexId> intervalRanks;
+        std::vector<VertexId> treeLows; //First post-order rank in the spanning tree of the first traversal under each component
+
+        void buildClosure(const std::vector<VertexId>& topologicalOrder); //Fills closureBits in reverse topological order
+        void buildIntervalLabels(const std::vector<VertexId>& roots); //Fills the interval labels with one depth-first traversal from the roots per label
+
+        bool isLabelContained(VertexId origin, VertexId destination) const; //Returns false if some label proves that origin cannot reach destination
+        bool isTreeDescendant(VertexId origin, VertexId destination) const; //Returns true if destination is under origin in the spanning tree of the first traversal
+        bool searchComponents(VertexId origin, VertexId destination) const; //Pruned depth-first search of the DAG for the queries that the labels do not decide
+};
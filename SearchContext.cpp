@@ -0,0 +1,28 @@
+#include "SearchContext.h"
+
+constexpr SearchContext::VertexId SearchContext::invalidVertexId;
+
+SearchContext::SearchContext() : currentStamp(0), settledCount(0) {
+}
+
+SearchContext& SearchContext::getThreadContext(size_t index) {
+    static thread_local SearchContext contexts[2];
+    return contexts[index];
+}
+
+void SearchContext::reset(size_t vertexCount) {
+    if (labels.size() < vertexCount) { //New labels get stamp 0, which is older than any search
+        labels.resize(vertexCount, Label {std::numeric_limits<double>::max(), invalidVertexId, 0});
+    }
+
+    currentStamp += 2;
+    if (currentStamp >= std::numeric_limits<std::uint32_t>::max() - 1) { //The stamps wrapped around, so the old labels have to be cleared once
+        for (Label& label : labels) {
+            label.stamp = 0;
+        }
+        currentStamp = 2;
+    }
+
+    settledCount = 0;
+    heap.clear();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "DaryHeap.h"
+
+/*
+Notes:
+SearchContext owns the per-vertex buffers (distance, predecessor, and settled state) and the heap used by a shortest path search
+
+Buffers are reset lazily with timestamps - each search increments the current stamp, and a vertex's label is only valid if its stamp belongs to the current search
+Therefore starting a search is O(1), and a search only touches the vertices it actually reaches
+Memory is only allocated when the context is used with a larger graph than before, so repeated searches on the same context perform no heap allocations
+
+A context may be reused across graphs, but it must not be shared between threads or used by two searches at once
+getThreadContext gives each thread two contexts of its own, which the query methods of FlightGraph and ContractionHierarchy use when the caller does not pass any
+*/
+
+class SearchContext {
+    public:
+        typedef std::uint32_t VertexId; //Same as FlightGraph::VertexId
+        static constexpr VertexId invalidVertexId = std::numeric_limits<VertexId>::max(); //Same as FlightGraph::invalidVertexId
+
+        SearchContext(); //Creates an empty context (buffers are allocated by the first reset)
+
+        static SearchContext& getThreadContext(size_t index); //Returns the calling thread's context with the given index (0 for unidirectional searches and the forward half of bidirectional searches, 1 for the backward half)
+
+        void reset(size_t vertexCount); //Starts a new search over a graph with vertexCount vertices - all vertices become unreached and the heap is cleared
+
+        bool isReached(VertexId vertex) const; //Returns whether the vertex has a tentative distance in the current search
+        bool isSettled(VertexId vertex) const; //Returns whether the vertex's distance is final in the current search
+        double getDistance(VertexId vertex) const; //Returns the tentative distance of the vertex (std::numeric_limits<double>::max() if it is unreached)
+        VertexId getPredecessor(VertexId vertex) const; //Returns the predecessor of the vertex (invalidVertexId if it is unreached or it is the origin)
+
+        void setDistance(VertexId vertex, double distance, VertexId predecessor); //Marks an unsettled vertex as reached with the given tentative distance and predecessor
+        void settle(VertexId vertex); //Marks a reached vertex as settled
+        size_t getSettledCount() const; //Returns the number of vertices settled by the current search
+
+        DaryHeap<VertexId> heap; //Priority queue of the current search (its memory is kept between searches)
+
+    private:
+        struct Label { //Per-vertex state, which is kept together so that a relaxation touches a single cache line
+            double distance;
+            VertexId predecessor;
+            std::uint32_t stamp; //currentStamp if reached, currentStamp + 1 if settled, and anything smaller if the label is from an earlier search
+        };
+
+        std::vector<Label> labels;
+        std::uint32_t currentStamp; //Always even (each search uses two stamp values)
+        size_t settledCount;
+};
+
+inline bool SearchContext::isReached(VertexId vertex) const {
+    return labels[vertex].stamp >= currentStamp;
+}
+
+inline bool SearchContext::isSettled(VertexId vertex) const {
+    return labels[vertex].stamp == currentStamp + 1;
+}
+
+inline double SearchContext::getDistance(VertexId vertex) const {
+    return isReached(vertex) ? labels[vertex].distance : std::numeric_limits<double>::max();
+}
+
+inline SearchContext::VertexId SearchContext::getPredecessor(VertexId vertex) const {
+    return isReached(vertex) ? labels[vertex].predecessor : invalidVertexId;
+}
+
+inline void SearchContext::setDistance(VertexId vertex, double distance, VertexId predecessor) {
+    Label& label = labels[vertex];
+    label.distance = distance;
+    label.predecessor = predecessor;
+    label.stamp = currentStamp;
+}
+
+inline void SearchContext::settle(VertexId vertex) {
+    labels[vertex].stamp = currentStamp + 1;
+    ++settledCount;
+}
+
+inline size_t SearchContext::getSettledCount() const {
+    return settledCount;
+}
@@ -0,0 +1,113 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(size_t threadCount) : currentTask(nullptr), batchNumber(0), activeWorkerCount(0), isStopping(false), remainingTaskCount(0) {
+    threadCount = std::max<size_t>(threadCount, 1);
+    for (size_t i = 0; i < threadCount; ++i) {
+        queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.push_back(std::thread(&ThreadPool::runWorker, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        isStopping = true;
+    }
+    batchStarted.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return threads.size();
+}
+
+void ThreadPool::run(size_t taskCount, const std::function<void(size_t task, size_t worker)>& task) {
+    if (taskCount == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> runLock(runMutex);
+
+    //Fills the queues before the batch is announced, so a worker that wakes up finds its whole block
+    for (size_t worker = 0; worker < queues.size(); ++worker) {
+        std::lock_guard<std::mutex> queueLock(queues.at(worker)->mutex);
+        for (size_t i = taskCount * worker / queues.size(); i < taskCount * (worker + 1) / queues.size(); ++i) {
+            queues.at(worker)->tasks.push_back(i);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(stateMutex);
+    currentTask = &task;
+    firstException = nullptr;
+    remainingTaskCount = taskCount;
+    ++batchNumber;
+    batchStarted.notify_all();
+    batchFinished.wait(lock, [this]() { return remainingTaskCount == 0 && activeWorkerCount == 0; });
+    currentTask = nullptr;
+    if (firstException) {
+        std::rethrow_exception(firstException);
+    }
+}
+
+//A worker only joins a batch while it is running (currentTask is set), and run does not return until every worker that joined has left
+//Therefore a worker never takes a task of the next batch while holding the function of the previous one
+void ThreadPool::runWorker(size_t worker) {
+    size_t seenBatchNumber = 0;
+    while (true) {
+        const std::function<void(size_t, size_t)>* task = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            batchStarted.wait(lock, [&]() { return isStopping || (currentTask != nullptr && batchNumber != seenBatchNumber); });
+            if (isStopping) {
+                return;
+            }
+            seenBatchNumber = batchNumber;
+            task = currentTask;
+            ++activeWorkerCount;
+        }
+
+        size_t taskIndex = 0;
+        while (takeTask(worker, taskIndex)) {
+            try {
+                (*task)(taskIndex, worker);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                if (!firstException) {
+                    firstException = std::current_exception();
+                }
+            }
+            --remainingTaskCount;
+        }
+
+        std::lock_guard<std::mutex> lock(stateMutex);
+        --activeWorkerCount;
+        if (remainingTaskCount == 0 && activeWorkerCount == 0) {
+            batchFinished.notify_all();
+        }
+    }
+}
+
+bool ThreadPool::takeTask(size_t worker, size_t& task) {
+    {
+        WorkerQueue& queue = *queues.at(worker);
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); ++i) { //Steals from the other workers, starting with the next one
+        WorkerQueue& victim = *queues.at((worker + i) % queues.size());
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+Notes:
+ThreadPool keeps a fixed set of worker threads that run batches of independent tasks (https://en.wikipedia.org/wiki/Work_stealing)
+
+A batch of tasks 0, ..., taskCount - 1 is split into one contiguous block per worker, and each worker takes tasks from the back of its own queue
+A worker whose queue is empty steals from the front of another worker's queue, so uneven tasks (e.g., searches from origins with many destinations) are balanced automatically
+
+Every task is told which worker runs it, so callers can keep one set of buffers (e.g., SearchContext) per worker without locking
+Only one batch runs at a time - run blocks until every task of the batch has finished
+*/
+
+class ThreadPool {
+    public:
+        ThreadPool(size_t threadCount = std::thread::hardware_concurrency()); //Starts threadCount workers (at least one)
+        ~ThreadPool(); //Stops and joins the workers
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t getThreadCount() const; //Returns the number of workers
+
+        void run(size_t taskCount, const std::function<void(size_t task, size_t worker)>& task); //Calls task(i, worker) for every i in [0, taskCount) on the workers and waits for all of them - rethrows the first exception thrown by a task (the remaining tasks still run)
+
+    private:
+        struct WorkerQueue { //Task indices of one worker
+            std::mutex mutex;
+            std::deque<size_t> tasks;
+        };
+
+        std::vector<std::thread> threads;
+        std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+        std::mutex runMutex; //Serializes calls to run
+        std::mutex stateMutex; //Guards the fields below
+        std::condition_variable batchStarted;
+        std::condition_variable batchFinished;
+        const std::function<void(size_t, size_t)>* currentTask;
+        size_t batchNumber; //Incremented by every batch, so idle workers know when new tasks arrive
+        size_t activeWorkerCount; //Workers that joined the current batch and have not run out of tasks yet
+        bool isStopping;
+        std::exception_ptr firstException;
+        std::atomic<size_t> remainingTaskCount; //Tasks of the current batch that have not finished
+
+        void runWorker(size_t worker); //Main loop of a worker thread
+        bool takeTask(size_t worker, size_t& task); //Pops a task from the worker's own queue or steals one from another queue - returns false if every queue is empty
+};
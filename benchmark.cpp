@@ -0,0 +1,196 @@
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <cmath>
+
+#include "FlightGraph.h"
+#include "ContractionHierarchy.h"
+#include "HubLabels.h"
+#include "ReachabilityIndex.h"
+#include "ThreadPool.h"
+
+/*
+Compares the point-to-point shortest path engines on random pairs of airports
+The route file and airport file are read from options.txt (as in main.cpp), and the pairs are drawn from the component of the origin airport
+*/
+
+//Prints one row of the results table
+void printRow(const std::string& name, size_t queryCount, double settledTotal, double microsecondsTotal) {
+    std::cout << std::left << std::setw(28) << name;
+    std::cout << std::right << std::setw(16) << std::fixed << std::setprecision(1) << settledTotal / queryCount;
+    std::cout << std::setw(16) << std::fixed << std::setprecision(2) << microsecondsTotal / queryCount << std::endl;
+}
+
+int main() {
+    //Store options from options.txt in optionsVector
+    std::vector<std::string> optionsVector;
+
+    std::ifstream stream("options.txt");
+    std::string currentOption;
+    while (std::getline(stream, currentOption)) {
+        optionsVector.push_back(currentOption);
+    }
+
+    const std::string& inputRouteFile = optionsVector.at(0);
+    const std::string& inputAirportFile = optionsVector.at(1);
+    const std::string& origin = optionsVector.at(2);
+
+    //Initialize graph
+    FlightGraph graph(inputRouteFile, inputAirportFile);
+
+    //Draw random pairs from the component of the origin airport (fixed seed, so runs are comparable)
+    std::vector<FlightGraph::VertexId> component = graph.breadthFirstSearch(graph.getVertexId(origin)).front();
+    std::mt19937 generator(2022);
+    std::uniform_int_distribution<size_t> distribution(0, component.size() - 1);
+    size_t queryCount = 1000;
+    std::vector<std::pair<FlightGraph::VertexId, FlightGraph::VertexId>> queries;
+    for (size_t i = 0; i < queryCount; ++i) {
+        queries.push_back(std::make_pair(component.at(distribution(generator)), component.at(distribution(generator))));
+    }
+
+    std::cout << "Input route file: " << inputRouteFile << " (" << graph.edgeList.size() << " unique routes)" << std::endl;
+    std::cout << "Input airport file: " << inputAirportFile << " (" << graph.airportCodeList.size() << " unique airports)" << std::endl;
+    std::cout << queryCount << " random queries from the component of " << origin << " (" << component.size() << " airports)" << std::endl;
+    std::cout << std::left << std::setw(28) << "Algorithm" << std::right << std::setw(16) << "Avg settled" << std::setw(16) << "Avg time (us)" << std::endl;
+
+    SearchContext context;
+    SearchContext backwardContext;
+    std::vector<FlightGraph::VertexId> path;
+    std::vector<double> referenceDistances; //Distances from the unidirectional search, used to check the other engines
+    size_t mismatchCount = 0;
+
+    //Unidirectional Dijkstra
+    double settledTotal = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::pair<FlightGraph::VertexId, FlightGraph::VertexId>& query : queries) {
+        graph.findShortestPath(query.first, query.second, context, path);
+        settledTotal += context.getSettledCount();
+        referenceDistances.push_back(context.getDistance(query.second));
+    }
+    printRow("Dijkstra", queryCount, settledTotal, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+    //Bidirectional Dijkstra
+    settledTotal = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queryCount; ++i) {
+        double distance = graph.findShortestPathBidirectional(queries.at(i).first, queries.at(i).second, context, backwardContext, path);
+        settledTotal += context.getSettledCount() + backwardContext.getSettledCount();
+        mismatchCount += std::abs(distance - referenceDistances.at(i)) > 1e-6 * referenceDistances.at(i);
+    }
+    printRow("Bidirectional Dijkstra", queryCount, settledTotal, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+    //A* with the great-circle lower bound
+    settledTotal = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queryCount; ++i) {
+        double distance = graph.findShortestPathAStar(queries.at(i).first, queries.at(i).second, context, path);
+        settledTotal += context.getSettledCount();
+        mismatchCount += std::abs(distance - referenceDistances.at(i)) > 1e-6 * referenceDistances.at(i);
+    }
+    printRow("A* (great-circle)", queryCount, settledTotal, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+    //ALT with 16 landmarks (preprocessing time is reported separately)
+    start = std::chrono::steady_clock::now();
+    graph.preprocessLandmarks(16, FlightGraph::LandmarkSelection::Avoid);
+    std::cout << "(ALT preprocessing with " << graph.landmarks.size() << " landmarks took " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms)" << std::endl;
+    settledTotal = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queryCount; ++i) {
+        double distance = graph.findShortestPathALT(queries.at(i).first, queries.at(i).second, context, path);
+        settledTotal += context.getSettledCount();
+        mismatchCount += std::abs(distance - referenceDistances.at(i)) > 1e-6 * referenceDistances.at(i);
+    }
+    printRow("ALT (16 landmarks)", queryCount, settledTotal, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+    //Contraction hierarchies (preprocessing time is reported separately)
+    start = std::chrono::steady_clock::now();
+    ContractionHierarchy hierarchy(graph);
+    std::cout << "(Contraction hierarchy preprocessing with " << hierarchy.getShortcutCount() << " shortcuts took " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms)" << std::endl;
+    settledTotal = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queryCount; ++i) {
+        double distance = hierarchy.findShortestPath(queries.at(i).first, queries.at(i).second, context, backwardContext, path);
+        settledTotal += context.getSettledCount() + backwardContext.getSettledCount();
+        mismatchCount += std::abs(distance - referenceDistances.at(i)) > 1e-6 * referenceDistances.at(i);
+    }
+    printRow("Contraction hierarchies", queryCount, settledTotal, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+    //Hub labels built from the hierarchy (the settled column counts the label entries scanned)
+    start = std::chrono::steady_clock::now();
+    HubLabels labels(graph, hierarchy);
+    std::cout << "(Hub labeling with " << labels.getEntryCount() << " label entries took " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms)" << std::endl;
+    settledTotal = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queryCount; ++i) {
+        double distance = labels.getDistance(queries.at(i).first, queries.at(i).second);
+        settledTotal += labels.forwardLabelOffsets.at(queries.at(i).first + 1) - labels.forwardLabelOffsets.at(queries.at(i).first);
+        settledTotal += labels.backwardLabelOffsets.at(queries.at(i).second + 1) - labels.backwardLabelOffsets.at(queries.at(i).second);
+        mismatchCount += std::abs(distance - referenceDistances.at(i)) > 1e-6 * referenceDistances.at(i);
+    }
+    printRow("Hub labels", queryCount, settledTotal, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+    //Batch Dijkstra on a thread pool, for the random queries and for queries that share 10 origins (each distinct origin is searched once)
+    ThreadPool pool;
+    std::vector<std::pair<FlightGraph::VertexId, FlightGraph::VertexId>> sharedOriginQueries;
+    for (size_t i = 0; i < queryCount; ++i) {
+        sharedOriginQueries.push_back(std::make_pair(queries.at(i % 10).first, queries.at(i).second));
+    }
+    for (const std::vector<std::pair<FlightGraph::VertexId, FlightGraph::VertexId>>* batch : {&queries, &sharedOriginQueries}) {
+        start = std::chrono::steady_clock::now();
+        const std::vector<std::vector<FlightGraph::VertexId>>& paths = graph.findShortestPaths(*batch, pool);
+        double microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        for (size_t i = 0; i < batch->size(); ++i) {
+            graph.findShortestPath(batch->at(i).first, batch->at(i).second, context, path);
+            mismatchCount += paths.at(i) != path;
+        }
+        std::cout << "(Batch of " << batch->size() << " queries " << (batch == &queries ? "with random origins" : "with 10 origins") << " on " << pool.getThreadCount() << " threads took " << std::setprecision(2) << microseconds / batch->size() << " us per query)" << std::endl;
+    }
+
+    //Distance matrix between 500 random sources and 500 random targets
+    std::vector<FlightGraph::VertexId> sources;
+    std::vector<FlightGraph::VertexId> targets;
+    for (size_t i = 0; i < 500; ++i) {
+        sources.push_back(queries.at(i).first);
+        targets.push_back(queries.at(i + 500).second);
+    }
+    start = std::chrono::steady_clock::now();
+    const std::vector<double>& distances = graph.distanceMatrix(sources, targets, pool);
+    std::cout << "(Distance matrix of " << sources.size() << " x " << targets.size() << " airports on " << pool.getThreadCount() << " threads took " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms)" << std::endl;
+    for (size_t i = 0; i < sources.size(); i += 50) {
+        for (size_t j = 0; j < targets.size(); j += 50) {
+            graph.findShortestPath(sources.at(i), targets.at(j), context, path);
+            mismatchCount += distances.at(i * targets.size() + j) != context.getDistance(targets.at(j));
+        }
+    }
+
+    //Breadth-first search of every component from the origin airport, on the calling thread and on the pool (both give the same traversal)
+    size_t searchCount = 100;
+    for (bool isParallel : {false, true}) {
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < searchCount; ++i) {
+            mismatchCount += (isParallel ? graph.breadthFirstSearch(graph.getVertexId(origin), pool) : graph.breadthFirstSearch(graph.getVertexId(origin))).front().size() != component.size();
+        }
+        double microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "(Breadth-first search " << (isParallel ? "on " + std::to_string(pool.getThreadCount()) + " threads" : "on the calling thread") << " took " << std::setprecision(2) << microseconds / searchCount << " us)" << std::endl;
+    }
+
+    //Reachability index on the strongly connected components (the settled column is 0, since queries do not search)
+    start = std::chrono::steady_clock::now();
+    ReachabilityIndex reachability(graph);
+    std::cout << "(Reachability index over " << reachability.getComponentCount() << " strongly connected components took " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms)" << std::endl;
+    std::vector<bool> reachable;
+    start = std::chrono::steady_clock::now();
+    for (const std::pair<FlightGraph::VertexId, FlightGraph::VertexId>& query : queries) {
+        reachable.push_back(reachability.isReachable(query.first, query.second));
+    }
+    printRow("Reachability index", queryCount, 0.0, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    for (size_t i = 0; i < queryCount; ++i) {
+        mismatchCount += reachable.at(i) != (referenceDistances.at(i) != std::numeric_limits<double>::max());
+    }
+
+    std::cout << "(" << mismatchCount << " distances differ from Dijkstra)" << std::endl;
+}
@@ -2,9 +2,26 @@
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <filesystem>
 
 #include "FlightGraph.h"
 
+//Returns whether the snapshot file exists and was written after every input file (so it cannot be stale)
+bool isSnapshotCurrent(const std::string& snapshotFile, const std::vector<std::string>& inputFiles) {
+    std::error_code error;
+    std::filesystem::file_time_type snapshotTime = std::filesystem::last_write_time(snapshotFile, error);
+    if (error) {
+        return false;
+    }
+    for (const std::string& inputFile : inputFiles) {
+        std::filesystem::file_time_type inputTime = std::filesystem::last_write_time(inputFile, error);
+        if (error || inputTime > snapshotTime) {
+            return false;
+        }
+    }
+    return true;
+}
+
 int main() {
     //Store options from options.txt in optionsVector
     std::vector<std::string> optionsVector;
@@ -20,9 +37,16 @@ int main() {
     const std::string& origin = optionsVector.at(2);
     const std::string& landmark = optionsVector.at(3);
     const std::string& destination = optionsVector.at(4);
+    const std::string snapshotFile = optionsVector.size() > 5 ? optionsVector.at(5) : ""; //Optional
     
-    //Initialize graph
-    FlightGraph graph(inputRouteFile, inputAirportFile);
+    //Initialize graph (from the snapshot file if there is a current one, and otherwise from the input files, writing the snapshot file for the next run)
+    FlightGraph graph;
+    if (snapshotFile.empty() || !isSnapshotCurrent(snapshotFile, std::vector<std::string> {inputRouteFile, inputAirportFile}) || !graph.loadSnapshot(snapshotFile)) {
+        graph = FlightGraph(inputRouteFile, inputAirportFile);
+        if (!snapshotFile.empty()) {
+            graph.saveSnapshot(snapshotFile);
+        }
+    }
 
     std::cout << "Input route file: " << inputRouteFile << " (" << graph.edgeList.size() << " unique routes)" << std::endl;
     std::cout << "Input airport file: " << inputAirportFile << " (" << graph.airportCodeList.size() << " unique airports)" << std::endl;
@@ -1,10 +1,20 @@
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iterator>
 #include <map>
+#include <random>
 #include <set>
 #include <string>
+#include <unordered_set>
 
 #include "catch.hpp"
 
 #include "FlightGraph.h"
+#include "ContractionHierarchy.h"
+#include "HubLabels.h"
+#include "ReachabilityIndex.h"
 
 /*
 Test format copied from mp_lists
@@ -37,6 +47,88 @@ CMI    |
      \ |
       DFW
 */
+
+//Returns (route file, airport file) pairs of the directed and undirected test graphs, followed by OpenFlights if includeOpenFlights is true
+std::vector<std::pair<std::string, std::string>> getTestGraphFiles(bool includeOpenFlights) {
+    std::vector<std::pair<std::string, std::string>> files {{"routes-test-undirected.dat", "airports-test.dat"}, {"routes-test-directed.dat", "airports-test.dat"}};
+    if (includeOpenFlights) {
+        files.push_back(std::make_pair("routes.dat", "airports-extended.dat"));
+    }
+    return files;
+}
+
+//Calls check for every pair of airports of graph right after the unidirectional Dijkstra search between them, which is the reference for the other engines
+//context holds that search (context.getDistance(destination) is the reference distance), and path is its path
+void forEachReferencePath(const FlightGraph& graph, const std::function<void(FlightGraph::VertexId origin, FlightGraph::VertexId destination, const SearchContext& context, const std::vector<FlightGraph::VertexId>& path)>& check) {
+    SearchContext context;
+    std::vector<FlightGraph::VertexId> path;
+    for (FlightGraph::VertexId origin = 0; origin < graph.getVertexCount(); ++origin) {
+        for (FlightGraph::VertexId destination = 0; destination < graph.getVertexCount(); ++destination) {
+            graph.findShortestPath(origin, destination, context, path);
+            check(origin, destination, context, path);
+        }
+    }
+}
+
+//Writes a synthetic graph that is large enough to take the parallel paths of components and stronglyConnectedComponents:
+//a ring of 80000 airports with chords (one large component with wide search levels), a ring of 10000 airports that it reaches, 2000 rings of 5 airports between them,
+//6000 chains of 4 airports into and out of the large ring (long trimming rounds), and 10000 separate pairs of airports
+void writeLargeTestGraph(const std::string& routeFile, const std::string& airportFile) {
+    const size_t largeRingSize = 80000;
+    const size_t smallRingBegin = largeRingSize;
+    const size_t smallRingSize = 10000;
+    const size_t ringsBegin = smallRingBegin + smallRingSize;
+    const size_t ringCount = 2000;
+    const size_t chainsInBegin = ringsBegin + 5 * ringCount;
+    const size_t chainCount = 6000;
+    const size_t chainsOutBegin = chainsInBegin + 4 * chainCount;
+    const size_t pairsBegin = chainsOutBegin + 4 * chainCount;
+    const size_t airportCount = pairsBegin + 2 * 10000;
+
+    auto getCode = [](size_t airport) {
+        std::string code;
+        for (size_t i = 0; i < 4; ++i, airport /= 36) {
+            code += "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"[airport % 36];
+        }
+        return code;
+    };
+    std::ofstream airports(airportFile);
+    for (size_t airport = 0; airport < airportCount; ++airport) {
+        airports << airport << ",\"A\",\"B\",\"C\",\"" << getCode(airport) << "\",\"" << getCode(airport) << "\"," << -60 + (airport % 1201) * 0.1 << "," << -179 + (airport / 1201) * 0.25 << ",0,0,\"U\",\"X\",\"airport\",\"Y\"\n";
+    }
+    std::ofstream routes(routeFile);
+    auto writeRoute = [&](size_t source, size_t target) {
+        routes << "XX,1," << getCode(source) << ",1," << getCode(target) << ",1,,0,X\n";
+    };
+    for (size_t i = 0; i < largeRingSize; ++i) {
+        writeRoute(i, (i + 1) % largeRingSize);
+        writeRoute(i, (i * 7919 + 13) % largeRingSize);
+    }
+    for (size_t i = 0; i < smallRingSize; ++i) {
+        writeRoute(smallRingBegin + i, smallRingBegin + (i + 1) % smallRingSize);
+        writeRoute(smallRingBegin + i, smallRingBegin + (i * 101 + 7) % smallRingSize);
+    }
+    writeRoute(0, smallRingBegin);
+    for (size_t ring = 0; ring < ringCount; ++ring) {
+        for (size_t i = 0; i < 5; ++i) {
+            writeRoute(ringsBegin + 5 * ring + i, ringsBegin + 5 * ring + (i + 1) % 5);
+        }
+        writeRoute(ring * 37 % largeRingSize, ringsBegin + 5 * ring);
+        writeRoute(ringsBegin + 5 * ring, smallRingBegin + ring);
+    }
+    for (size_t chain = 0; chain < chainCount; ++chain) {
+        for (size_t i = 0; i < 3; ++i) {
+            writeRoute(chainsInBegin + 4 * chain + i, chainsInBegin + 4 * chain + i + 1);
+            writeRoute(chainsOutBegin + 4 * chain + i, chainsOutBegin + 4 * chain + i + 1);
+        }
+        writeRoute(chainsInBegin + 4 * chain + 3, chain * 13 % largeRingSize);
+        writeRoute(chain * 17 % largeRingSize, chainsOutBegin + 4 * chain);
+    }
+    for (size_t airport = pairsBegin; airport < airportCount; airport += 2) {
+        writeRoute(airport, airport + 1);
+    }
+}
+
 TEST_CASE("FlightGraph Undirected") { //Tests constructors and member variables
     FlightGraph graph("routes-test-undirected.dat", "airports-test.dat");
 
@@ -143,7 +235,7 @@ TEST_CASE("FlightGraph Undirected") { //Tests constructors and member variables
         {"YYZ", "STL"}
     });
 
-    //adjacencyMatrix
+    //adjacencyOffsets, adjacencyTargets, and adjacencyWeights (compared against the dense adjacency matrix, where negative values are nonexistent edges)
     std::vector<std::vector<double>> adjacencyMatrixTest = {
         {-1, 1114, -1, -1, -1, 218, -1, -1, -1},
         {1114, -1, 1881, 361, -1, 1290, -1, -1, -1},
@@ -155,15 +247,23 @@ TEST_CASE("FlightGraph Undirected") { //Tests constructors and member variables
         {-1, -1, -1, 1075, 721, -1, 1071, -1, 1050},
         {-1, -1, -1, -1, 1088, -1, 870, 1050, -1}
     };
-    REQUIRE(graph.adjacencyMatrix.size() == adjacencyMatrixTest.size()); //Size tests
-    for (size_t originIndex = 0; originIndex < adjacencyMatrixTest.size(); ++originIndex) {
-        REQUIRE(graph.adjacencyMatrix.at(originIndex).size() == adjacencyMatrixTest.at(originIndex).size());
-    }
+    REQUIRE(graph.adjacencyOffsets.size() == adjacencyMatrixTest.size() + 1); //Size tests
+    REQUIRE(graph.adjacencyOffsets.front() == 0);
+    REQUIRE(graph.adjacencyOffsets.back() == graph.edgeList.size());
+    REQUIRE(graph.adjacencyTargets.size() == graph.edgeList.size());
+    REQUIRE(graph.adjacencyWeights.size() == graph.edgeList.size());
     double relativeErrorTolerance = 0.01;
-    for (size_t originIndex = 0; originIndex < adjacencyMatrixTest.size(); ++originIndex) { //Value tests
+    for (size_t originIndex = 0; originIndex < adjacencyMatrixTest.size(); ++originIndex) { //Value tests (each CSR row is expanded into a dense row)
+        std::vector<double> row(adjacencyMatrixTest.size(), -1.0);
+        for (size_t i = graph.adjacencyOffsets.at(originIndex); i < graph.adjacencyOffsets.at(originIndex + 1); ++i) {
+            if (i > graph.adjacencyOffsets.at(originIndex)) {
+                REQUIRE(graph.adjacencyTargets.at(i - 1) < graph.adjacencyTargets.at(i)); //Rows are sorted
+            }
+            REQUIRE(graph.adjacencyWeights.at(i) > 0);
+            row.at(graph.adjacencyTargets.at(i)) = graph.adjacencyWeights.at(i);
+        }
         for (size_t destinationIndex = 0; destinationIndex < adjacencyMatrixTest.at(originIndex).size(); ++destinationIndex) {
-            REQUIRE(graph.adjacencyMatrix.at(originIndex).at(destinationIndex) == Approx(adjacencyMatrixTest.at(originIndex).at(destinationIndex)).epsilon(relativeErrorTolerance));
-            REQUIRE_FALSE(graph.adjacencyMatrix.at(originIndex).at(destinationIndex) == 0);
+            REQUIRE(row.at(destinationIndex) == Approx(adjacencyMatrixTest.at(originIndex).at(destinationIndex)).epsilon(relativeErrorTolerance));
         }
     }
 }
@@ -268,7 +368,7 @@ TEST_CASE("FlightGraph Directed") {
         {"YYZ", "STL"}
     });
 
-    //adjacencyMatrix
+    //adjacencyOffsets, adjacencyTargets, and adjacencyWeights (compared against the dense adjacency matrix, where negative values are nonexistent edges)
     std::vector<std::vector<double>> adjacencyMatrixTest = {
         {-1, -1, -1, -1, -1, 218, -1, -1, -1},
         {1114, -1, 1881, 361, -1, 1290, -1, -1, -1},
@@ -280,15 +380,23 @@ TEST_CASE("FlightGraph Directed") {
         {-1, -1, -1, 1075, 721, -1, 1071, -1, 1050},
         {-1, -1, -1, -1, 1088, -1, 870, 1050, -1}
     };
-    REQUIRE(graph.adjacencyMatrix.size() == adjacencyMatrixTest.size()); //Size tests
-    for (size_t originIndex = 0; originIndex < adjacencyMatrixTest.size(); ++originIndex) {
-        REQUIRE(graph.adjacencyMatrix.at(originIndex).size() == adjacencyMatrixTest.at(originIndex).size());
-    }
+    REQUIRE(graph.adjacencyOffsets.size() == adjacencyMatrixTest.size() + 1); //Size tests
+    REQUIRE(graph.adjacencyOffsets.front() == 0);
+    REQUIRE(graph.adjacencyOffsets.back() == graph.edgeList.size());
+    REQUIRE(graph.adjacencyTargets.size() == graph.edgeList.size());
+    REQUIRE(graph.adjacencyWeights.size() == graph.edgeList.size());
     double relativeErrorTolerance = 0.01;
-    for (size_t originIndex = 0; originIndex < adjacencyMatrixTest.size(); ++originIndex) { //Value tests
+    for (size_t originIndex = 0; originIndex < adjacencyMatrixTest.size(); ++originIndex) { //Value tests (each CSR row is expanded into a dense row)
+        std::vector<double> row(adjacencyMatrixTest.size(), -1.0);
+        for (size_t i = graph.adjacencyOffsets.at(originIndex); i < graph.adjacencyOffsets.at(originIndex + 1); ++i) {
+            if (i > graph.adjacencyOffsets.at(originIndex)) {
+                REQUIRE(graph.adjacencyTargets.at(i - 1) < graph.adjacencyTargets.at(i)); //Rows are sorted
+            }
+            REQUIRE(graph.adjacencyWeights.at(i) > 0);
+            row.at(graph.adjacencyTargets.at(i)) = graph.adjacencyWeights.at(i);
+        }
         for (size_t destinationIndex = 0; destinationIndex < adjacencyMatrixTest.at(originIndex).size(); ++destinationIndex) {
-            REQUIRE(graph.adjacencyMatrix.at(originIndex).at(destinationIndex) == Approx(adjacencyMatrixTest.at(originIndex).at(destinationIndex)).epsilon(relativeErrorTolerance));
-            REQUIRE_FALSE(graph.adjacencyMatrix.at(originIndex).at(destinationIndex) == 0);
+            REQUIRE(row.at(destinationIndex) == Approx(adjacencyMatrixTest.at(originIndex).at(destinationIndex)).epsilon(relativeErrorTolerance));
         }
     }
 }
@@ -537,6 +645,192 @@ TEST_CASE("breadthFirstSearch Directed") {
     REQUIRE(graph.breadthFirstSearch("YYZ") == std::vector<std::vector<std::string>> {{"YYZ", "MSP", "RDU", "STL", "IAD", "ORD", "IAH", "DFW", "CMI"}});
 }
 
+TEST_CASE("breadthFirstSearch direction-optimizing") { //Bottom-up levels must keep the order of a FIFO queue, so the traversal must match a plain queue-based search from every root
+    FlightGraph graph("routes.dat", "airports-extended.dat");
+    for (FlightGraph::VertexId root = 0; root < graph.getVertexCount(); root += 97) {
+        std::vector<bool> visited(graph.getVertexCount(), false);
+        std::vector<std::vector<FlightGraph::VertexId>> expected;
+        for (size_t i = 0; i <= graph.getVertexCount(); ++i) {
+            FlightGraph::VertexId start = i == 0 ? root : (FlightGraph::VertexId) (i - 1); //The root's component comes first
+            if (visited.at(start)) {
+                continue;
+            }
+            std::vector<FlightGraph::VertexId> traversal {start};
+            visited.at(start) = true;
+            for (size_t i = 0; i < traversal.size(); ++i) {
+                for (FlightGraph::VertexId target : graph.neighbors(traversal.at(i))) {
+                    if (!visited.at(target)) {
+                        visited.at(target) = true;
+                        traversal.push_back(target);
+                    }
+                }
+            }
+            expected.push_back(traversal);
+        }
+        REQUIRE(graph.breadthFirstSearch(root) == expected);
+    }
+
+    //The helper only visits vertices that are not visited yet, and marks them
+    std::vector<bool> visited(graph.getVertexCount(), false);
+    const std::vector<FlightGraph::VertexId>& first = graph.breadthFirstSearch(graph.getVertexId("CMI"), visited);
+    REQUIRE(first == graph.breadthFirstSearch(graph.getVertexId("CMI")).front());
+    REQUIRE((size_t) std::count(visited.begin(), visited.end(), true) == first.size());
+    REQUIRE(graph.breadthFirstSearch(graph.getVertexId("ORD"), visited) == std::vector<FlightGraph::VertexId> {graph.getVertexId("ORD")});
+}
+
+TEST_CASE("breadthFirstSearch parallel") { //The parallel search must give exactly the serial traversal for any number of threads
+    ThreadPool pool(3);
+    ThreadPool singleThreadPool(1);
+    for (const std::pair<std::string, std::string>& file : getTestGraphFiles(false)) {
+        FlightGraph graph(file.first, file.second);
+        for (const std::string& root : graph.airportCodeList) {
+            REQUIRE(graph.breadthFirstSearch(root, pool) == graph.breadthFirstSearch(root));
+        }
+    }
+
+    FlightGraph graph("routes.dat", "airports-extended.dat");
+    for (const char* root : {"CMI", "ORD", "AKL", "HND", "LHR"}) { //Hubs have frontiers large enough to be split into tasks
+        const std::vector<std::vector<FlightGraph::VertexId>>& expected = graph.breadthFirstSearch(graph.getVertexId(root));
+        REQUIRE(graph.breadthFirstSearch(graph.getVertexId(root), pool) == expected);
+        REQUIRE(graph.breadthFirstSearch(graph.getVertexId(root), singleThreadPool) == expected);
+    }
+    REQUIRE_THROWS_AS(graph.breadthFirstSearch("XXX", pool), std::out_of_range);
+}
+
+TEST_CASE("components") { //Components must be the breadth-first search components when routes are followed in either direction
+    ThreadPool pool(3);
+    std::vector<std::pair<std::string, std::string>> files = getTestGraphFiles(true);
+    files.push_back(std::make_pair("test-large-routes.dat", "test-large-airports.dat")); //Splits the edges into several tasks
+    writeLargeTestGraph(files.back().first, files.back().second);
+    for (const std::pair<std::string, std::string>& file : files) {
+        FlightGraph graph(file.first, file.second);
+        std::vector<FlightGraph::VertexId> expected(graph.getVertexCount(), FlightGraph::invalidVertexId);
+        std::vector<size_t> expectedSizes;
+        for (FlightGraph::VertexId start = 0; start < graph.getVertexCount(); ++start) {
+            if (expected.at(start) != FlightGraph::invalidVertexId) {
+                continue;
+            }
+            std::vector<FlightGraph::VertexId> traversal {start};
+            expected.at(start) = (FlightGraph::VertexId) expectedSizes.size();
+            for (size_t i = 0; i < traversal.size(); ++i) {
+                for (const FlightGraph::NeighborRange& range : {graph.neighbors(traversal.at(i)), graph.reverseNeighbors(traversal.at(i))}) {
+                    for (FlightGraph::VertexId target : range) {
+                        if (expected.at(target) == FlightGraph::invalidVertexId) {
+                            expected.at(target) = (FlightGraph::VertexId) expectedSizes.size();
+                            traversal.push_back(target);
+                        }
+                    }
+                }
+            }
+            expectedSizes.push_back(traversal.size());
+        }
+
+        const FlightGraph::ComponentLabels& labels = graph.components();
+        REQUIRE(labels.componentIds == expected);
+        REQUIRE(labels.componentSizes == expectedSizes);
+        const FlightGraph::ComponentLabels& parallelLabels = graph.components(pool);
+        REQUIRE(parallelLabels.componentIds == expected);
+        REQUIRE(parallelLabels.componentSizes == expectedSizes);
+    }
+    std::remove("test-large-routes.dat");
+    std::remove("test-large-airports.dat");
+}
+
+TEST_CASE("stronglyConnectedComponents") { //Two airports must share a component exactly if each can reach the other
+    ThreadPool pool(3);
+    std::vector<std::pair<std::string, std::string>> files = getTestGraphFiles(true);
+    files.push_back(std::make_pair("test-large-routes.dat", "test-large-airports.dat")); //Takes the parallel trimming rounds and the parallel searches of large partitions
+    writeLargeTestGraph(files.back().first, files.back().second);
+    for (const std::pair<std::string, std::string>& file : files) {
+        FlightGraph graph(file.first, file.second);
+        const FlightGraph::ComponentLabels& labels = graph.stronglyConnectedComponents();
+        REQUIRE(labels.componentIds.size() == graph.getVertexCount());
+        REQUIRE(graph.stronglyConnectedComponents(pool).componentIds == labels.componentIds);
+        REQUIRE(graph.stronglyConnectedComponents(pool).componentSizes == labels.componentSizes);
+
+        //Reachability from a sample of origins (every origin on the test graphs)
+        std::vector<size_t> sizes(labels.componentSizes.size(), 0);
+        FlightGraph::VertexId nextId = 0;
+        bool isNumberedInOrder = true; //Numbered in order of the smallest vertex
+        for (FlightGraph::VertexId vertex = 0; vertex < graph.getVertexCount(); ++vertex) {
+            isNumberedInOrder = isNumberedInOrder && labels.componentIds.at(vertex) <= nextId;
+            nextId = std::max<FlightGraph::VertexId>(nextId, labels.componentIds.at(vertex) + 1);
+            ++sizes.at(labels.componentIds.at(vertex));
+        }
+        REQUIRE(isNumberedInOrder);
+        REQUIRE(sizes == labels.componentSizes);
+        std::vector<std::vector<bool>> reaches;
+        std::vector<FlightGraph::VertexId> origins;
+        for (FlightGraph::VertexId origin = 0; origin < graph.getVertexCount(); origin += (graph.getVertexCount() > 100000 ? 4999 : (graph.getVertexCount() > 100 ? 53 : 1))) {
+            origins.push_back(origin);
+        }
+        for (bool reverse : {false, true}) {
+            for (FlightGraph::VertexId origin : origins) {
+                std::vector<bool> visited(graph.getVertexCount(), false);
+                std::vector<FlightGraph::VertexId> queue {origin};
+                visited.at(origin) = true;
+                for (size_t i = 0; i < queue.size(); ++i) {
+                    for (FlightGraph::VertexId target : (reverse ? graph.reverseNeighbors(queue.at(i)) : graph.neighbors(queue.at(i)))) {
+                        if (!visited.at(target)) {
+                            visited.at(target) = true;
+                            queue.push_back(target);
+                        }
+                    }
+                }
+                reaches.push_back(visited);
+            }
+        }
+        size_t mismatchCount = 0;
+        for (size_t i = 0; i < origins.size(); ++i) {
+            for (FlightGraph::VertexId vertex = 0; vertex < graph.getVertexCount(); ++vertex) {
+                bool isMutual = reaches.at(i).at(vertex) && reaches.at(origins.size() + i).at(vertex);
+                mismatchCount += isMutual != (labels.componentIds.at(vertex) == labels.componentIds.at(origins.at(i)));
+            }
+        }
+        REQUIRE(mismatchCount == 0);
+    }
+    std::remove("test-large-routes.dat");
+    std::remove("test-large-airports.dat");
+}
+
+TEST_CASE("ReachabilityIndex") { //Both the transitive closure and the interval labels must agree with a breadth-first search from a sample of origins
+    for (const std::pair<std::string, std::string>& file : getTestGraphFiles(true)) {
+        FlightGraph graph(file.first, file.second);
+        ReachabilityIndex closureIndex(graph);
+        ReachabilityIndex labelIndex(graph, 0);
+        REQUIRE(closureIndex.hasTransitiveClosure());
+        REQUIRE(!labelIndex.hasTransitiveClosure());
+        REQUIRE(closureIndex.getComponentCount() == graph.stronglyConnectedComponents().componentSizes.size());
+
+        size_t mismatchCount = 0;
+        for (FlightGraph::VertexId origin = 0; origin < graph.getVertexCount(); origin += (graph.getVertexCount() > 100 ? 97 : 1)) {
+            std::vector<bool> visited(graph.getVertexCount(), false);
+            std::vector<FlightGraph::VertexId> queue {origin};
+            visited.at(origin) = true;
+            for (size_t i = 0; i < queue.size(); ++i) {
+                for (FlightGraph::VertexId target : graph.neighbors(queue.at(i))) {
+                    if (!visited.at(target)) {
+                        visited.at(target) = true;
+                        queue.push_back(target);
+                    }
+                }
+            }
+            for (FlightGraph::VertexId destination = 0; destination < graph.getVertexCount(); ++destination) {
+                mismatchCount += closureIndex.isReachable(origin, destination) != visited.at(destination);
+                mismatchCount += labelIndex.isReachable(origin, destination) != visited.at(destination);
+            }
+        }
+        REQUIRE(mismatchCount == 0);
+    }
+
+    //The directed test graph is strongly connected, since ORD reaches CMI through DFW
+    FlightGraph graph("routes-test-directed.dat", "airports-test.dat");
+    ReachabilityIndex index(graph);
+    REQUIRE(index.getComponentCount() == 1);
+    REQUIRE(index.isReachable("ORD", "CMI"));
+    REQUIRE(index.isReachable("CMI", "CMI"));
+}
+
 TEST_CASE("findShortestPath Undirected") {
     FlightGraph graph("routes-test-undirected.dat", "airports-test.dat");
 
@@ -725,6 +1019,404 @@ TEST_CASE("findShortestPath Directed") {
     REQUIRE(graph.findShortestPath("YYZ", "YYZ") == std::vector<std::string> {"YYZ"});
 }
 
+TEST_CASE("findShortestPath Bidirectional") { //The bidirectional search must agree with the unidirectional search on every pair of airports
+    for (const std::pair<std::string, std::string>& file : getTestGraphFiles(false)) {
+        FlightGraph graph(file.first, file.second);
+        SearchContext forwardContext;
+        SearchContext backwardContext;
+        std::vector<FlightGraph::VertexId> bidirectionalPath;
+        forEachReferencePath(graph, [&](FlightGraph::VertexId origin, FlightGraph::VertexId destination, const SearchContext& context, const std::vector<FlightGraph::VertexId>& path) {
+            REQUIRE(graph.findShortestPath(graph.getAirportCode(origin), graph.getAirportCode(destination), FlightGraph::ShortestPathAlgorithm::BidirectionalDijkstra) == graph.findShortestPath(graph.getAirportCode(origin), graph.getAirportCode(destination)));
+
+            double distance = graph.findShortestPathBidirectional(origin, destination, forwardContext, backwardContext, bidirectionalPath);
+            REQUIRE(bidirectionalPath == path);
+            REQUIRE(distance == Approx(context.getDistance(destination)));
+        });
+    }
+
+    //Reverse CSR (incoming edges)
+    FlightGraph graph("routes-test-directed.dat", "airports-test.dat");
+    const FlightGraph::NeighborRange& incoming = graph.reverseNeighbors(graph.getVertexId("ORD"));
+    REQUIRE(std::vector<FlightGraph::VertexId>(incoming.begin(), incoming.end()) == std::vector<FlightGraph::VertexId> {graph.getVertexId("CMI"), graph.getVertexId("DFW"), graph.getVertexId("RDU")});
+    REQUIRE(graph.reverseNeighbors(graph.getVertexId("CMI")).size() == 1);
+    REQUIRE(graph.reverseAdjacencyTargets.size() == graph.adjacencyTargets.size());
+}
+
+TEST_CASE("findShortestPath AStar") { //A* must agree with Dijkstra on every pair of airports
+    for (const std::pair<std::string, std::string>& file : getTestGraphFiles(false)) {
+        FlightGraph graph(file.first, file.second);
+        SearchContext aStarContext;
+        std::vector<FlightGraph::VertexId> aStarPath;
+        forEachReferencePath(graph, [&](FlightGraph::VertexId origin, FlightGraph::VertexId destination, const SearchContext& context, const std::vector<FlightGraph::VertexId>& path) {
+            const std::string& originCode = graph.getAirportCode(origin);
+            const std::string& destinationCode = graph.getAirportCode(destination);
+            REQUIRE(graph.findShortestPath(originCode, destinationCode, FlightGraph::ShortestPathAlgorithm::AStar) == graph.findShortestPath(originCode, destinationCode));
+
+            double distance = graph.findShortestPathAStar(origin, destination, aStarContext, aStarPath);
+            REQUIRE(aStarPath == path);
+            REQUIRE(distance == Approx(context.getDistance(destination)));
+            REQUIRE(aStarContext.getSettledCount() <= context.getSettledCount());
+
+            //The lower bound is the great-circle distance (within a meter) and never exceeds the shortest path
+            double greatCircleDistance = graph.convertCoordinatesToKilometers(graph.airportCodeToLatitudeLongitudeMap.at(originCode), graph.airportCodeToLatitudeLongitudeMap.at(destinationCode));
+            REQUIRE(graph.getGreatCircleLowerBound(origin, destination) == Approx(greatCircleDistance).margin(0.002));
+            REQUIRE(graph.getGreatCircleLowerBound(origin, destination) <= distance);
+        });
+    }
+}
+
+TEST_CASE("findShortestPath ALT") { //ALT must agree with Dijkstra on every pair of airports for both landmark strategies
+    for (const std::pair<std::string, std::string>& file : getTestGraphFiles(false)) {
+        for (FlightGraph::LandmarkSelection selection : {FlightGraph::LandmarkSelection::Farthest, FlightGraph::LandmarkSelection::Avoid}) {
+            FlightGraph graph(file.first, file.second);
+            graph.preprocessLandmarks(3, selection);
+            REQUIRE(graph.landmarks.size() == 3);
+            REQUIRE(graph.landmarkDistancesFrom.size() == 3 * graph.getVertexCount());
+            REQUIRE(graph.landmarkDistancesTo.size() == 3 * graph.getVertexCount());
+            REQUIRE(std::set<FlightGraph::VertexId>(graph.landmarks.begin(), graph.landmarks.end()).size() == 3); //Landmarks are distinct
+
+            SearchContext altContext;
+            std::vector<FlightGraph::VertexId> altPath;
+            forEachReferencePath(graph, [&](FlightGraph::VertexId origin, FlightGraph::VertexId destination, const SearchContext& context, const std::vector<FlightGraph::VertexId>& path) {
+                REQUIRE(graph.findShortestPath(graph.getAirportCode(origin), graph.getAirportCode(destination), FlightGraph::ShortestPathAlgorithm::ALT) == graph.findShortestPath(graph.getAirportCode(origin), graph.getAirportCode(destination)));
+
+                double distance = graph.findShortestPathALT(origin, destination, altContext, altPath);
+                REQUIRE(altPath == path);
+                REQUIRE(distance == Approx(context.getDistance(destination)));
+                REQUIRE(graph.getLandmarkLowerBound(origin, destination) <= distance);
+            });
+
+            //A landmark's lower bound to itself from another airport is exact (up to the one meter slack)
+            SearchContext context;
+            std::vector<FlightGraph::VertexId> path;
+            FlightGraph::VertexId landmark = graph.landmarks.front();
+            for (FlightGraph::VertexId vertex = 0; vertex < graph.getVertexCount(); ++vertex) {
+                graph.findShortestPath(vertex, landmark, context, path);
+                REQUIRE_FALSE(context.getDistance(landmark) == std::numeric_limits<double>::max()); //Every airport in the test graphs can reach every other airport
+                REQUIRE(graph.getLandmarkLowerBound(vertex, landmark) == Approx(context.getDistance(landmark)).margin(0.002));
+            }
+        }
+    }
+
+    //Landmarks survive a save and load, and files for other graphs are rejected
+    FlightGraph graph("routes-test-directed.dat", "airports-test.dat");
+    REQUIRE(graph.getLandmarkLowerBound(0, 1) == 0); //No landmarks yet
+    REQUIRE_FALSE(graph.loadLandmarks("missing-landmarks.bin"));
+    graph.preprocessLandmarks(2);
+    REQUIRE(graph.saveLandmarks("test-landmarks.bin"));
+    FlightGraph loadedGraph("routes-test-directed.dat", "airports-test.dat");
+    REQUIRE(loadedGraph.loadLandmarks("test-landmarks.bin"));
+    REQUIRE(loadedGraph.landmarks == graph.landmarks);
+    REQUIRE(loadedGraph.landmarkDistancesFrom == graph.landmarkDistancesFrom);
+    REQUIRE(loadedGraph.landmarkDistancesTo == graph.landmarkDistancesTo);
+    FlightGraph largerGraph("routes.dat", "airports-extended.dat");
+    REQUIRE_FALSE(largerGraph.loadLandmarks("test-landmarks.bin"));
+    REQUIRE(largerGraph.landmarks.empty());
+    FlightGraph sameSizeGraph("routes-test-undirected.dat", "airports-test.dat"); //Same airports, different routes
+    REQUIRE(sameSizeGraph.getVertexCount() == graph.getVertexCount());
+    REQUIRE_FALSE(sameSizeGraph.loadLandmarks("test-landmarks.bin"));
+    REQUIRE(sameSizeGraph.landmarks.empty());
+    {
+        std::ofstream file("test-landmarks.bin", std::ios::binary); //Valid header followed by a landmark code of 4 GiB
+        std::uint32_t version = 2;
+        std::uint64_t vertexCount = graph.getVertexCount();
+        std::uint64_t checksum = graph.getGraphChecksum();
+        std::uint64_t landmarkCount = 1;
+        std::uint32_t codeSize = 0xFFFFFFFF;
+        file.write("FGALT", 5);
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        file.write(reinterpret_cast<const char*>(&vertexCount), sizeof(vertexCount));
+        file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+        file.write(reinterpret_cast<const char*>(&landmarkCount), sizeof(landmarkCount));
+        file.write(reinterpret_cast<const char*>(&codeSize), sizeof(codeSize));
+    }
+    REQUIRE_FALSE(loadedGraph.loadLandmarks("test-landmarks.bin"));
+    REQUIRE(loadedGraph.landmarks == graph.landmarks);
+    std::remove("test-landmarks.bin");
+}
+
+TEST_CASE("ContractionHierarchy") { //Contraction hierarchy queries must agree with Dijkstra on every pair of airports
+    for (const std::pair<std::string, std::string>& file : getTestGraphFiles(false)) {
+        FlightGraph graph(file.first, file.second);
+        ContractionHierarchy hierarchy(graph);
+
+        //Every vertex gets a distinct rank, and hierarchy edges always lead to more important vertices
+        REQUIRE(std::set<size_t>(hierarchy.rank.begin(), hierarchy.rank.end()).size() == graph.getVertexCount());
+        for (FlightGraph::VertexId vertex = 0; vertex < graph.getVertexCount(); ++vertex) {
+            for (size_t i = hierarchy.forwardOffsets.at(vertex); i < hierarchy.forwardOffsets.at(vertex + 1); ++i) {
+                REQUIRE(hierarchy.rank.at(hierarchy.forwardTargets.at(i)) > hierarchy.rank.at(vertex));
+            }
+            for (size_t i = hierarchy.backwardOffsets.at(vertex); i < hierarchy.backwardOffsets.at(vertex + 1); ++i) {
+                REQUIRE(hierarchy.rank.at(hierarchy.backwardTargets.at(i)) > hierarchy.rank.at(vertex));
+            }
+        }
+        REQUIRE(hierarchy.forwardTargets.size() + hierarchy.backwardTargets.size() == graph.adjacencyTargets.size() + hierarchy.getShortcutCount());
+
+        SearchContext forwardContext;
+        SearchContext backwardContext;
+        std::vector<FlightGraph::VertexId> hierarchyPath;
+        forEachReferencePath(graph, [&](FlightGraph::VertexId origin, FlightGraph::VertexId destination, const SearchContext& context, const std::vector<FlightGraph::VertexId>& path) {
+            REQUIRE(hierarchy.findShortestPath(graph.getAirportCode(origin), graph.getAirportCode(destination)) == graph.findShortestPath(graph.getAirportCode(origin), graph.getAirportCode(destination)));
+
+            double distance = hierarchy.findShortestPath(origin, destination, forwardContext, backwardContext, hierarchyPath);
+            REQUIRE(hierarchyPath == path);
+            REQUIRE(distance == Approx(context.getDistance(destination)));
+            REQUIRE(hierarchy.getDistance(origin, destination, forwardContext, backwardContext) == Approx(distance));
+        });
+    }
+}
+
+TEST_CASE("HubLabels") { //Hub label distances must agree with Dijkstra on every pair of airports
+    for (const std::pair<std::string, std::string>& file : getTestGraphFiles(false)) {
+        FlightGraph graph(file.first, file.second);
+        ContractionHierarchy hierarchy(graph);
+        HubLabels labels(graph, hierarchy);
+
+        //Every airport is its own hub, and labels are sorted by hub
+        for (FlightGraph::VertexId vertex = 0; vertex < graph.getVertexCount(); ++vertex) {
+            REQUIRE(labels.getDistance(vertex, vertex) == 0);
+            REQUIRE(labels.getHub(vertex, vertex) == vertex);
+            for (size_t i = labels.forwardLabelOffsets.at(vertex) + 1; i < labels.forwardLabelOffsets.at(vertex + 1); ++i) {
+                REQUIRE(labels.forwardLabelHubs.at(i - 1) < labels.forwardLabelHubs.at(i));
+            }
+            for (size_t i = labels.backwardLabelOffsets.at(vertex) + 1; i < labels.backwardLabelOffsets.at(vertex + 1); ++i) {
+                REQUIRE(labels.backwardLabelHubs.at(i - 1) < labels.backwardLabelHubs.at(i));
+            }
+        }
+
+        forEachReferencePath(graph, [&](FlightGraph::VertexId origin, FlightGraph::VertexId destination, const SearchContext& context, const std::vector<FlightGraph::VertexId>&) {
+            REQUIRE(labels.getDistance(graph.getAirportCode(origin), graph.getAirportCode(destination)) == Approx(context.getDistance(destination)));
+        });
+    }
+
+    //Labels survive a save and load, and files for other graphs are rejected
+    FlightGraph graph("routes-test-directed.dat", "airports-test.dat");
+    HubLabels emptyLabels(graph);
+    REQUIRE(emptyLabels.getDistance(0, 1) == std::numeric_limits<double>::max()); //No labels yet
+    REQUIRE(emptyLabels.getHub(0, 1) == FlightGraph::invalidVertexId);
+    REQUIRE_FALSE(emptyLabels.load("missing-labels.bin"));
+    HubLabels labels(graph, ContractionHierarchy(graph));
+    REQUIRE(labels.save("test-labels.bin"));
+    REQUIRE(emptyLabels.load("test-labels.bin"));
+    REQUIRE(emptyLabels.forwardLabelOffsets == labels.forwardLabelOffsets);
+    REQUIRE(emptyLabels.forwardLabelHubs == labels.forwardLabelHubs);
+    REQUIRE(emptyLabels.forwardLabelDistances == labels.forwardLabelDistances);
+    REQUIRE(emptyLabels.backwardLabelOffsets == labels.backwardLabelOffsets);
+    REQUIRE(emptyLabels.backwardLabelHubs == labels.backwardLabelHubs);
+    REQUIRE(emptyLabels.backwardLabelDistances == labels.backwardLabelDistances);
+    FlightGraph undirectedGraph("routes-test-undirected.dat", "airports-test.dat");
+    HubLabels otherLabels(undirectedGraph);
+    REQUIRE_FALSE(otherLabels.load("test-labels.bin")); //Same airports but different routes
+    {
+        std::ifstream input("airports-test.dat");
+        std::ofstream output("test-airports-moved.dat");
+        std::string line;
+        while (std::getline(input, line)) {
+            size_t position = line.find("43.6772003174"); //Moves YYZ one degree north
+            output << (position == std::string::npos ? line : line.replace(position, 2, "44")) << std::endl;
+        }
+    }
+    FlightGraph movedGraph("routes-test-directed.dat", "test-airports-moved.dat");
+    HubLabels movedLabels(movedGraph);
+    REQUIRE_FALSE(movedLabels.load("test-labels.bin")); //Same routes but different weights
+    std::remove("test-airports-moved.dat");
+    FlightGraph largerGraph("routes.dat", "airports-extended.dat");
+    HubLabels largerLabels(largerGraph);
+    REQUIRE_FALSE(largerLabels.load("test-labels.bin"));
+    REQUIRE(largerLabels.getEntryCount() == 0);
+    {
+        std::ifstream input("test-labels.bin", std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        std::string corrupted = contents;
+        std::uint64_t hubCount = 0x0FFFFFFFFFFFFFFF;
+        corrupted.replace(33 + (graph.getVertexCount() + 1) * sizeof(size_t), sizeof(hubCount), reinterpret_cast<const char*>(&hubCount), sizeof(hubCount)); //Forward hub count after the header and the forward offsets
+        std::ofstream("test-labels.bin", std::ios::binary) << corrupted;
+        REQUIRE_FALSE(emptyLabels.load("test-labels.bin"));
+        std::ofstream("test-labels.bin", std::ios::binary) << contents.substr(0, contents.size() / 2); //Truncated
+        REQUIRE_FALSE(emptyLabels.load("test-labels.bin"));
+        REQUIRE(emptyLabels.forwardLabelHubs == labels.forwardLabelHubs); //Unchanged by the failed loads
+    }
+    std::remove("test-labels.bin");
+}
+
+TEST_CASE("findShortestPaths") { //Batch queries must return the same paths as single queries, in input order
+    ThreadPool pool(3);
+    for (const std::pair<std::string, std::string>& file : getTestGraphFiles(false)) {
+        FlightGraph graph(file.first, file.second);
+        std::vector<std::pair<std::string, std::string>> queries;
+        for (const std::string& origin : graph.airportCodeList) {
+            for (const std::string& destination : graph.airportCodeList) {
+                queries.push_back(std::make_pair(destination, origin)); //Origins are interleaved, so grouping has to restore the input order
+            }
+        }
+        const std::vector<std::vector<std::string>>& paths = graph.findShortestPaths(queries, pool);
+        REQUIRE(paths.size() == queries.size());
+        for (size_t i = 0; i < queries.size(); ++i) {
+            REQUIRE(paths.at(i) == graph.findShortestPath(queries.at(i).first, queries.at(i).second));
+        }
+    }
+
+    //Random queries with repeated origins and destinations (including unreachable destinations) on the full database
+    FlightGraph graph("routes.dat", "airports-extended.dat");
+    std::mt19937 generator(2022);
+    std::uniform_int_distribution<FlightGraph::VertexId> distribution(0, 99);
+    std::vector<std::pair<FlightGraph::VertexId, FlightGraph::VertexId>> queries;
+    for (size_t i = 0; i < 500; ++i) {
+        queries.push_back(std::make_pair(distribution(generator) * 17, distribution(generator) * 31));
+    }
+    ThreadPool singleThreadPool(1);
+    const std::vector<std::vector<FlightGraph::VertexId>>& paths = graph.findShortestPaths(queries, pool);
+    REQUIRE(graph.findShortestPaths(queries, singleThreadPool) == paths);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        REQUIRE(paths.at(i) == graph.findShortestPath(queries.at(i).first, queries.at(i).second));
+    }
+
+    REQUIRE(graph.findShortestPaths(std::vector<std::pair<FlightGraph::VertexId, FlightGraph::VertexId>> {}, pool).empty());
+    REQUIRE_THROWS_AS(graph.findShortestPaths(std::vector<std::pair<std::string, std::string>> {{"CMI", "XXX"}}, pool), std::out_of_range);
+}
+
+TEST_CASE("findShortestPathTree") { //Every path in the tree must be the path of a single query
+    for (const std::pair<std::string, std::string>& file : getTestGraphFiles(false)) {
+        FlightGraph graph(file.first, file.second);
+        std::vector<FlightGraph::ShortestPathTree> trees; //Tree of each origin
+        for (const std::string& origin : graph.airportCodeList) {
+            trees.push_back(graph.findShortestPathTree(origin));
+            const FlightGraph::ShortestPathTree& tree = trees.back();
+            REQUIRE(tree.origin == graph.getVertexId(origin));
+            REQUIRE(tree.distances.size() == graph.getVertexCount());
+            REQUIRE(tree.parents.size() == graph.getVertexCount());
+            REQUIRE(tree.distances.at(tree.origin) == 0.0);
+            REQUIRE(tree.parents.at(tree.origin) == FlightGraph::invalidVertexId);
+        }
+        forEachReferencePath(graph, [&](FlightGraph::VertexId origin, FlightGraph::VertexId destination, const SearchContext& context, const std::vector<FlightGraph::VertexId>& path) {
+            const FlightGraph::ShortestPathTree& tree = trees.at(origin);
+            REQUIRE(tree.getPath(destination) == path);
+            REQUIRE(tree.distances.at(destination) == context.getDistance(destination));
+            REQUIRE(tree.isReachable(destination) == context.isSettled(destination));
+        });
+    }
+
+    //The full database has unreachable airports, and a reused tree must not keep entries from its previous origin
+    FlightGraph graph("routes.dat", "airports-extended.dat");
+    SearchContext context;
+    FlightGraph::ShortestPathTree tree;
+    std::vector<FlightGraph::VertexId> treePath;
+    std::vector<FlightGraph::VertexId> path;
+    for (const char* origin : {"CMI", "AKL", "HND"}) {
+        graph.findShortestPathTree(graph.getVertexId(origin), context, tree);
+        for (FlightGraph::VertexId destination = 0; destination < graph.getVertexCount(); destination += 7) {
+            graph.findShortestPath(tree.origin, destination, context, path);
+            tree.getPath(destination, treePath);
+            REQUIRE(treePath == path);
+            REQUIRE(tree.distances.at(destination) == context.getDistance(destination));
+        }
+    }
+    REQUIRE_THROWS_AS(graph.findShortestPathTree("XXX"), std::out_of_range);
+}
+
+TEST_CASE("ShortestPathTreeCache") {
+    FlightGraph graph("routes.dat", "airports-extended.dat");
+    REQUIRE(graph.shortestPathTreeCache.getMemoryBudget() == FlightGraph::ShortestPathTreeCache::defaultMemoryBudget); //Enabled by default
+    REQUIRE(graph.shortestPathTreeCache.canHoldTree(graph.getVertexCount()));
+    graph.shortestPathTreeCache.setMemoryBudget(0);
+    REQUIRE_FALSE(graph.shortestPathTreeCache.canHoldTree(graph.getVertexCount()));
+    std::vector<std::vector<std::string>> itineraries = {{"CMI", "ORD", "HND"}, {"CMI", "ORD", "AKL"}, {"AKL", "ORD", "CMI"}, {"CMI", "LHR", "SYD", "ORD"}};
+    std::vector<std::vector<std::string>> uncachedPaths;
+    for (const std::vector<std::string>& itinerary : itineraries) {
+        uncachedPaths.push_back(graph.findShortestLandmarkPath(itinerary));
+    }
+    const std::vector<std::string>& uncachedPath = graph.findShortestPath("CMI", "SYD");
+    REQUIRE(graph.shortestPathTreeCache.getMissCount() == 0);
+
+    //Cached trees must give the same paths, and legs that share an origin must only search once
+    graph.shortestPathTreeCache.setMemoryBudget(size_t(64) << 20);
+    for (size_t i = 0; i < itineraries.size(); ++i) {
+        REQUIRE(graph.findShortestLandmarkPath(itineraries.at(i)) == uncachedPaths.at(i));
+    }
+    REQUIRE(graph.shortestPathTreeCache.getMissCount() == 5); //CMI, ORD, AKL, LHR, and SYD
+    REQUIRE(graph.shortestPathTreeCache.getHitCount() == 4);
+    REQUIRE(graph.shortestPathTreeCache.size() == 5);
+    REQUIRE(graph.findShortestPath("ORD", "CMI") == std::vector<std::string> {"ORD", "CMI"});
+    REQUIRE(graph.shortestPathTreeCache.getHitCount() == 5);
+
+    //A budget of two trees keeps the two most recently used origins
+    size_t treeMemory = graph.shortestPathTreeCache.getMemoryUsage() / 5;
+    graph.shortestPathTreeCache.setMemoryBudget(2 * treeMemory);
+    REQUIRE(graph.shortestPathTreeCache.size() == 2);
+    REQUIRE(graph.shortestPathTreeCache.getMemoryUsage() == 2 * treeMemory);
+    std::shared_ptr<const FlightGraph::ShortestPathTree> ordTree = graph.shortestPathTreeCache.find(graph.getVertexId("ORD")); //Most recently used
+    REQUIRE(ordTree != nullptr);
+    REQUIRE(graph.shortestPathTreeCache.find(graph.getVertexId("SYD")) != nullptr); //Used before ORD
+    REQUIRE(graph.shortestPathTreeCache.find(graph.getVertexId("CMI")) == nullptr);
+    graph.findShortestPath("CMI", "SYD"); //Evicts ORD, which is now the least recently used tree
+    REQUIRE(graph.shortestPathTreeCache.find(graph.getVertexId("ORD")) == nullptr);
+    REQUIRE(ordTree->getPath(graph.getVertexId("CMI")) == std::vector<FlightGraph::VertexId> {graph.getVertexId("ORD"), graph.getVertexId("CMI")}); //Evicted trees stay valid
+
+    //A tree larger than the budget is not cached
+    graph.shortestPathTreeCache.setMemoryBudget(1);
+    REQUIRE(graph.shortestPathTreeCache.size() == 0);
+    REQUIRE(graph.findShortestPath("CMI", "SYD") == uncachedPath); //Searches directly, since no tree fits
+    REQUIRE(graph.getShortestPathTree(graph.getVertexId("CMI"))->getPath(graph.getVertexId("SYD")).size() == uncachedPath.size()); //Searched but not cached
+    REQUIRE(graph.shortestPathTreeCache.size() == 0);
+    REQUIRE(graph.shortestPathTreeCache.getMemoryUsage() == 0);
+
+    //Copies keep the budget but not the trees, and loading a snapshot clears the trees
+    graph.shortestPathTreeCache.setMemoryBudget(size_t(64) << 20);
+    graph.findShortestPath("CMI", "HND");
+    FlightGraph copy = graph;
+    REQUIRE(copy.shortestPathTreeCache.getMemoryBudget() == graph.shortestPathTreeCache.getMemoryBudget());
+    REQUIRE(copy.shortestPathTreeCache.size() == 0);
+    REQUIRE(graph.shortestPathTreeCache.size() == 1);
+    REQUIRE(graph.saveSnapshot("tree-cache-test.snapshot"));
+    REQUIRE(graph.loadSnapshot("tree-cache-test.snapshot"));
+    std::remove("tree-cache-test.snapshot");
+    REQUIRE(graph.shortestPathTreeCache.size() == 0);
+    REQUIRE(graph.shortestPathTreeCache.getHitCount() + graph.shortestPathTreeCache.getMissCount() == 0);
+}
+
+TEST_CASE("distanceMatrix") { //Every entry must be the distance of a single query
+    ThreadPool pool(3);
+    SearchContext context;
+    std::vector<FlightGraph::VertexId> path;
+    FlightGraph testGraph("routes-test-directed.dat", "airports-test.dat");
+    const std::vector<double>& testDistances = testGraph.distanceMatrix(testGraph.airportCodeList, std::vector<std::string> {"ORD", "CMI", "ORD"}, pool);
+    REQUIRE(testDistances.size() == 3 * testGraph.getVertexCount());
+    for (FlightGraph::VertexId source = 0; source < testGraph.getVertexCount(); ++source) {
+        for (size_t j = 0; j < 3; ++j) {
+            FlightGraph::VertexId target = testGraph.getVertexId(j == 1 ? "CMI" : "ORD");
+            testGraph.findShortestPath(source, target, context, path);
+            REQUIRE(testDistances.at(source * 3 + j) == context.getDistance(target));
+        }
+    }
+
+    //Random sources and targets (with repeats and unreachable targets) on the full database
+    FlightGraph graph("routes.dat", "airports-extended.dat");
+    std::mt19937 generator(2022);
+    std::uniform_int_distribution<FlightGraph::VertexId> distribution(0, graph.getVertexCount() - 1);
+    std::vector<FlightGraph::VertexId> sources;
+    std::vector<FlightGraph::VertexId> targets;
+    for (size_t i = 0; i < 40; ++i) {
+        sources.push_back(distribution(generator));
+        targets.push_back(distribution(generator));
+    }
+    sources.push_back(sources.front());
+    targets.push_back(targets.front());
+    const std::vector<double>& distances = graph.distanceMatrix(sources, targets, pool);
+    REQUIRE(distances.size() == sources.size() * targets.size());
+    ThreadPool singleThreadPool(1);
+    REQUIRE(graph.distanceMatrix(sources, targets, singleThreadPool) == distances);
+    for (size_t i = 0; i < sources.size(); ++i) {
+        for (size_t j = 0; j < targets.size(); ++j) {
+            graph.findShortestPath(sources.at(i), targets.at(j), context, path);
+            REQUIRE(distances.at(i * targets.size() + j) == context.getDistance(targets.at(j)));
+        }
+    }
+
+    REQUIRE(graph.distanceMatrix(std::vector<FlightGraph::VertexId> {}, targets, pool).empty());
+    REQUIRE(graph.distanceMatrix(sources, std::vector<FlightGraph::VertexId> {}, pool).empty());
+    REQUIRE_THROWS_AS(graph.distanceMatrix(std::vector<std::string> {"CMI"}, std::vector<std::string> {"XXX"}, pool), std::out_of_range);
+}
+
 TEST_CASE("findShortestLandmarkPath Undirected") { //Since findShortestLandmarkPath heavily relies on findShortestPath (which has its own tests) and since there are too many possibilities to test individually, this test only tests a few possibilities
     FlightGraph graph("routes-test-undirected.dat", "airports-test.dat");
 
@@ -753,6 +1445,65 @@ TEST_CASE("findShortestLandmarkPath Undirected") { //Since findShortestLandmarkP
     REQUIRE(graph.findShortestLandmarkPath(std::vector<std::string> {"ORD", "MSP", "CMI"}) == std::vector<std::string> {"ORD", "RDU", "STL", "MSP", "STL", "RDU", "ORD", "CMI"});
 }
 
+TEST_CASE("findWaypointOrder") { //Orders must visit every waypoint once between the fixed origin and destination, and the exact orders must be as short as the best permutation
+    FlightGraph graph("routes.dat", "airports-extended.dat");
+    SearchContext context;
+    std::vector<FlightGraph::VertexId> path;
+    auto getLength = [&](const std::vector<FlightGraph::VertexId>& order) {
+        double length = 0.0;
+        for (size_t i = 0; i + 1 < order.size(); ++i) {
+            graph.findShortestPath(order.at(i), order.at(i + 1), context, path);
+            length += context.isSettled(order.at(i + 1)) ? context.getDistance(order.at(i + 1)) : 1e12;
+        }
+        return length;
+    };
+    std::vector<FlightGraph::VertexId> hubs;
+    for (const char* code : {"CMI", "ORD", "LHR", "HND", "SYD", "JNB", "GRU", "DXB", "SIN", "LAX", "YYZ", "CDG", "DEL", "MEX", "AKL", "SVO", "NBO", "SCL", "ANC", "HNL"}) {
+        hubs.push_back(graph.getVertexId(code));
+    }
+
+    //Exact orders against every permutation (including a repeated waypoint and an unreachable one)
+    std::vector<FlightGraph::VertexId> unreachable;
+    for (FlightGraph::VertexId vertex = 0; vertex < graph.getVertexCount() && unreachable.empty(); ++vertex) {
+        graph.findShortestPath(hubs.front(), vertex, context, path);
+        if (!context.isSettled(vertex)) {
+            unreachable.push_back(vertex);
+        }
+    }
+    REQUIRE(!unreachable.empty());
+    for (const std::vector<FlightGraph::VertexId>& waypoints : {std::vector<FlightGraph::VertexId> {hubs.at(0), hubs.at(5), hubs.at(2), hubs.at(9), hubs.at(3), hubs.at(6), hubs.at(1)},
+                                                                 std::vector<FlightGraph::VertexId> {hubs.at(4), hubs.at(7), hubs.at(8), hubs.at(7), hubs.at(12), hubs.at(4)},
+                                                                 std::vector<FlightGraph::VertexId> {hubs.at(0), hubs.at(3), unreachable.front(), hubs.at(14), hubs.at(10), hubs.at(11)}}) {
+        const std::vector<FlightGraph::VertexId>& order = graph.findWaypointOrder(waypoints);
+        REQUIRE(order.front() == waypoints.front());
+        REQUIRE(order.back() == waypoints.back());
+        REQUIRE(std::multiset<FlightGraph::VertexId>(order.begin(), order.end()) == std::multiset<FlightGraph::VertexId>(waypoints.begin(), waypoints.end()));
+        std::vector<FlightGraph::VertexId> permutation(waypoints);
+        std::sort(permutation.begin() + 1, permutation.end() - 1);
+        double bestLength = std::numeric_limits<double>::max();
+        do {
+            bestLength = std::min(bestLength, getLength(permutation));
+        } while (std::next_permutation(permutation.begin() + 1, permutation.end() - 1));
+        REQUIRE(getLength(order) == Approx(bestLength));
+    }
+
+    //Local search beyond the exact limit must not be longer than the given order
+    std::vector<FlightGraph::VertexId> waypoints(hubs);
+    waypoints.insert(waypoints.end(), hubs.begin() + 1, hubs.begin() + 2); //Repeated waypoint
+    REQUIRE(waypoints.size() - 2 > FlightGraph::maxExactWaypointCount);
+    const std::vector<FlightGraph::VertexId>& order = graph.findWaypointOrder(waypoints);
+    REQUIRE(order.front() == waypoints.front());
+    REQUIRE(order.back() == waypoints.back());
+    REQUIRE(std::multiset<FlightGraph::VertexId>(order.begin(), order.end()) == std::multiset<FlightGraph::VertexId>(waypoints.begin(), waypoints.end()));
+    REQUIRE(getLength(order) <= getLength(waypoints));
+
+    //findShortestLandmarkPath chains the legs in the optimal order
+    FlightGraph testGraph("routes-test-undirected.dat", "airports-test.dat");
+    REQUIRE(testGraph.findShortestLandmarkPath(std::vector<std::string> {"ORD", "MSP", "RDU", "STL", "CMI"}, FlightGraph::WaypointOrder::Shortest) == std::vector<std::string> {"ORD", "RDU", "STL", "MSP", "STL", "RDU", "ORD", "CMI"});
+    REQUIRE(testGraph.findShortestLandmarkPath(std::vector<std::string> {"CMI", "ORD"}, FlightGraph::WaypointOrder::Shortest) == std::vector<std::string> {"CMI", "ORD"});
+    REQUIRE(testGraph.findShortestLandmarkPath(std::vector<std::string> {"CMI"}, FlightGraph::WaypointOrder::Shortest).empty());
+}
+
 TEST_CASE("findShortestLandmarkPath Directed") {
     FlightGraph graph("routes-test-directed.dat", "airports-test.dat");
 
@@ -773,6 +1524,315 @@ TEST_CASE("findShortestLandmarkPath Directed") {
     REQUIRE(graph.findShortestLandmarkPath(std::vector<std::string> {"ORD", "MSP", "CMI"}) == std::vector<std::string> {"ORD", "RDU", "STL", "MSP", "STL", "IAH", "DFW", "CMI"});
 }
 
+TEST_CASE("CsvReader") {
+    std::string text = "1,\"Goroka Airport\",\"Goroka\",\"GKA\",-6.08\n2,\"Airport, With Comma\",\"X\",\"MAG\",-5.2\r\n\n3,\"Unclosed,field\n4,last";
+    std::string longText = "5,\"" + std::string(100, 'A') + ", Washington, D.C.\",\"DCA\"\r\n"; //The quoted field spans several 64-byte blocks
+    std::vector<std::string_view> fields;
+    for (int instructions = 0; instructions <= (int) CsvReader::getBestInstructions(); ++instructions) { //Every supported instruction set must give the same fields
+        CsvReader reader(text.data(), text.data() + text.size(), (CsvReader::Instructions) instructions);
+
+        REQUIRE(reader.readLine(fields));
+        REQUIRE(fields == std::vector<std::string_view> {"1", "\"Goroka Airport\"", "\"Goroka\"", "\"GKA\"", "-6.08"});
+        REQUIRE(CsvReader::parseDouble(fields.at(4)) == -6.08);
+
+        REQUIRE(reader.readLine(fields)); //The comma inside the quoted name does not split it, and the '\r' is dropped
+        REQUIRE(fields == std::vector<std::string_view> {"2", "\"Airport, With Comma\"", "\"X\"", "\"MAG\"", "-5.2"});
+
+        REQUIRE(reader.readLine(fields)); //Blank line
+        REQUIRE(fields == std::vector<std::string_view> {""});
+
+        REQUIRE(reader.readLine(fields)); //A quoted field that is never closed is split like an unquoted field
+        REQUIRE(fields == std::vector<std::string_view> {"3", "\"Unclosed", "field"});
+
+        REQUIRE(reader.readLine(fields)); //The last line does not need a newline
+        REQUIRE(fields == std::vector<std::string_view> {"4", "last"});
+        REQUIRE_FALSE(reader.readLine(fields));
+        REQUIRE(fields.empty());
+
+        CsvReader longReader(longText.data(), longText.data() + longText.size(), (CsvReader::Instructions) instructions);
+        REQUIRE(longReader.readLine(fields));
+        REQUIRE(fields == std::vector<std::string_view> {"5", "\"" + std::string(100, 'A') + ", Washington, D.C.\"", "\"DCA\""});
+        REQUIRE_FALSE(longReader.readLine(fields));
+
+        //The airport database has many quoted fields, so it exercises every instruction set against the scalar scanner
+        MappedFile airportFile("airports-extended.dat");
+        CsvReader scalarReader(airportFile.data(), airportFile.data() + airportFile.size(), CsvReader::Instructions::Scalar);
+        CsvReader airportReader(airportFile.data(), airportFile.data() + airportFile.size(), (CsvReader::Instructions) instructions);
+        std::vector<std::string_view> scalarFields;
+        size_t mismatchCount = 0;
+        while (scalarReader.readLine(scalarFields)) {
+            airportReader.readLine(fields);
+            mismatchCount += fields != scalarFields;
+        }
+        REQUIRE(mismatchCount == 0);
+        REQUIRE_FALSE(airportReader.readLine(fields));
+    }
+
+    REQUIRE_THROWS_AS(CsvReader::parseDouble("\\N"), std::invalid_argument);
+
+    //Chunks start on line boundaries and cover the whole text
+    std::vector<const char*> boundaries = CsvReader::findChunkBoundaries(text.data(), text.data() + text.size(), 4);
+    REQUIRE(boundaries.size() == 5);
+    REQUIRE(boundaries.front() == text.data());
+    REQUIRE(boundaries.back() == text.data() + text.size());
+    for (size_t i = 1; i < boundaries.size(); ++i) {
+        REQUIRE(boundaries.at(i - 1) <= boundaries.at(i));
+        REQUIRE((boundaries.at(i) == text.data() + text.size() || *(boundaries.at(i) - 1) == '\n'));
+    }
+    REQUIRE(CsvReader::findChunkBoundaries(text.data(), text.data() + text.size(), 100).size() == 101); //More chunks than lines gives empty chunks
+
+    //A missing file maps as an empty file, so it produces an empty graph
+    MappedFile missingFile("missing-routes.dat");
+    REQUIRE_FALSE(missingFile.isOpen());
+    REQUIRE(missingFile.size() == 0);
+    FlightGraph graph("missing-routes.dat", "missing-airports.dat");
+    REQUIRE(graph.getVertexCount() == 0);
+    REQUIRE(graph.adjacencyOffsets == std::vector<size_t> {0});
+
+    MappedFile routesFile("routes-test-directed.dat");
+    REQUIRE(routesFile.isOpen());
+    REQUIRE(std::string(routesFile.data(), routesFile.size()).find("ORD") != std::string::npos);
+}
+
+TEST_CASE("FlightGraph parallel ingestion") { //Parsing the route file on several threads must give exactly the same graph as parsing it on one thread
+    FlightGraph graph("routes.dat", "airports-extended.dat");
+    for (size_t threadCount : {2, 3, 8}) {
+        FlightGraph parallelGraph("routes.dat", "airports-extended.dat", threadCount);
+        REQUIRE(parallelGraph.airportCodeList == graph.airportCodeList);
+        REQUIRE(parallelGraph.airportCodeMap == graph.airportCodeMap);
+        REQUIRE(parallelGraph.edgeList == graph.edgeList);
+        REQUIRE(parallelGraph.edgeSet == graph.edgeSet);
+        REQUIRE(parallelGraph.airportCodeToLatitudeLongitudeMap == graph.airportCodeToLatitudeLongitudeMap);
+        REQUIRE(parallelGraph.adjacencyOffsets == graph.adjacencyOffsets);
+        REQUIRE(parallelGraph.adjacencyTargets == graph.adjacencyTargets);
+        REQUIRE(parallelGraph.adjacencyWeights == graph.adjacencyWeights);
+    }
+}
+
+TEST_CASE("FlightGraph snapshot") { //A loaded snapshot must be exactly the graph that was saved
+    for (const std::pair<std::string, std::string>& file : getTestGraphFiles(true)) {
+        FlightGraph graph(file.first, file.second);
+        REQUIRE(graph.saveSnapshot("test-graph.snapshot"));
+        FlightGraph loadedGraph;
+        REQUIRE(loadedGraph.getVertexCount() == 0);
+        REQUIRE(loadedGraph.loadSnapshot("test-graph.snapshot"));
+        REQUIRE(loadedGraph.airportCodeList == graph.airportCodeList);
+        REQUIRE(loadedGraph.airportCodeMap == graph.airportCodeMap);
+        REQUIRE(loadedGraph.airportCodeToLatitudeLongitudeMap == graph.airportCodeToLatitudeLongitudeMap);
+        REQUIRE(loadedGraph.edgeList == graph.edgeList);
+        REQUIRE(loadedGraph.edgeSet == graph.edgeSet);
+        REQUIRE(loadedGraph.unitSphereVectors == graph.unitSphereVectors);
+        REQUIRE(loadedGraph.adjacencyOffsets == graph.adjacencyOffsets);
+        REQUIRE(loadedGraph.adjacencyTargets == graph.adjacencyTargets);
+        REQUIRE(loadedGraph.adjacencyWeights == graph.adjacencyWeights);
+        REQUIRE(loadedGraph.reverseAdjacencyOffsets == graph.reverseAdjacencyOffsets);
+        REQUIRE(loadedGraph.reverseAdjacencyTargets == graph.reverseAdjacencyTargets);
+        REQUIRE(loadedGraph.reverseAdjacencyWeights == graph.reverseAdjacencyWeights);
+    }
+
+    //Damaged files are rejected, and the current graph is kept
+    FlightGraph graph("routes-test-directed.dat", "airports-test.dat");
+    graph.preprocessLandmarks(2);
+    REQUIRE(graph.saveSnapshot("test-graph.snapshot"));
+    std::ifstream input("test-graph.snapshot", std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+
+    FlightGraph loadedGraph("routes-test-undirected.dat", "airports-test.dat");
+    REQUIRE_FALSE(loadedGraph.loadSnapshot("missing-graph.snapshot"));
+    std::string corrupted = contents;
+    corrupted.at(corrupted.size() / 2) ^= 1; //Fails the checksum
+    std::ofstream("test-graph.snapshot", std::ios::binary) << corrupted;
+    REQUIRE_FALSE(loadedGraph.loadSnapshot("test-graph.snapshot"));
+    std::ofstream("test-graph.snapshot", std::ios::binary) << contents.substr(0, contents.size() - 8); //Truncated
+    REQUIRE_FALSE(loadedGraph.loadSnapshot("test-graph.snapshot"));
+    corrupted = contents;
+    corrupted.at(8) = 2; //Another version
+    std::ofstream("test-graph.snapshot", std::ios::binary) << corrupted;
+    REQUIRE_FALSE(loadedGraph.loadSnapshot("test-graph.snapshot"));
+    REQUIRE(loadedGraph.edgeList == FlightGraph("routes-test-undirected.dat", "airports-test.dat").edgeList);
+
+    //Loading replaces the graph and clears its landmarks (snapshots do not include landmarks)
+    std::ofstream("test-graph.snapshot", std::ios::binary) << contents;
+    loadedGraph.preprocessLandmarks(2);
+    REQUIRE(loadedGraph.loadSnapshot("test-graph.snapshot"));
+    REQUIRE(loadedGraph.landmarks.empty());
+    REQUIRE(loadedGraph.findShortestPath("CMI", "IAD") == graph.findShortestPath("CMI", "IAD"));
+    std::remove("test-graph.snapshot");
+}
+
+TEST_CASE("AirportCode") {
+    REQUIRE(AirportCode("ORD").toString() == "ORD");
+    REQUIRE(AirportCode("KORD").toString() == "KORD");
+    REQUIRE(AirportCode("ORD").size() == 3);
+    REQUIRE(AirportCode().toString() == "");
+    REQUIRE(AirportCode("") == AirportCode());
+    REQUIRE(AirportCode::fromValue(AirportCode("CMI").getValue()) == AirportCode("CMI"));
+    REQUIRE_FALSE(AirportCode::isValid("KORDX"));
+    REQUIRE_THROWS_AS(AirportCode("KORDX"), std::invalid_argument);
+    REQUIRE_THROWS_AS(AirportCode(std::string_view("A\0B", 3)), std::invalid_argument);
+
+    //Packed codes sort exactly like strings, including codes of different lengths
+    std::vector<std::string> codes {"", "A", "AB", "ABC", "ABCD", "ABD", "B", "Z9", "ZZZZ", "a", "ORD", "KORD", "1AB"};
+    for (const std::string& first : codes) {
+        for (const std::string& second : codes) {
+            REQUIRE((AirportCode(first) < AirportCode(second)) == (first < second));
+            REQUIRE((AirportCode(first) == AirportCode(second)) == (first == second));
+        }
+    }
+    std::unordered_set<AirportCode> codeSet {AirportCode("ORD"), AirportCode("ORD"), AirportCode("CMI")};
+    REQUIRE(codeSet.size() == 2);
+
+    //The graph stores a packed code for every airport, and packed codes resolve to the same vertex IDs as strings
+    FlightGraph graph("routes.dat", "airports-extended.dat");
+    REQUIRE(graph.airportCodes.size() == graph.getVertexCount());
+    for (FlightGraph::VertexId vertex = 0; vertex < graph.getVertexCount(); ++vertex) {
+        REQUIRE(graph.airportCodes.at(vertex).toString() == graph.getAirportCode(vertex));
+        REQUIRE(graph.getVertexId(graph.airportCodes.at(vertex)) == vertex);
+        REQUIRE(graph.findVertexId(graph.airportCodes.at(vertex)) == vertex);
+    }
+    REQUIRE(graph.findVertexId(AirportCode("XXXX")) == FlightGraph::invalidVertexId);
+    REQUIRE_THROWS_AS(graph.getVertexId(AirportCode("XXXX")), std::out_of_range);
+    REQUIRE_THROWS_AS(graph.getVertexId("TOO LONG"), std::out_of_range);
+
+    REQUIRE((size_t) std::count_if(graph.iataVertexIds.begin(), graph.iataVertexIds.end(), [](FlightGraph::VertexId vertex) { return vertex != FlightGraph::invalidVertexId; }) == graph.getVertexCount()); //Every code in routes.dat is a 3-letter IATA code
+
+    //Codes that are not 3-letter uppercase codes are found without the direct lookup table
+    std::ofstream("test-routes.dat") << "AA,24,CMI,4049,KORD,3830,Y,0,ER4\nAA,24,KORD,3830,cmi,4049,Y,0,ER4\nAA,24,cmi,3830,C1,4049,Y,0,ER4\n";
+    FlightGraph mixedGraph("test-routes.dat", "airports-test.dat");
+    REQUIRE(mixedGraph.airportCodeList == std::vector<std::string> {"C1", "CMI", "KORD", "cmi"});
+    for (FlightGraph::VertexId vertex = 0; vertex < mixedGraph.getVertexCount(); ++vertex) {
+        REQUIRE(mixedGraph.getVertexId(mixedGraph.airportCodeList.at(vertex)) == vertex);
+    }
+    REQUIRE(mixedGraph.findVertexId(AirportCode("ORD")) == FlightGraph::invalidVertexId);
+    REQUIRE(mixedGraph.findVertexId(AirportCode("KCMI")) == FlightGraph::invalidVertexId);
+    REQUIRE(FlightGraph().findVertexId(AirportCode("CMI")) == FlightGraph::invalidVertexId);
+
+    //Route files with codes that cannot be packed are rejected
+    std::ofstream("test-routes.dat") << "AA,24,CMI,4049,TOOLONG,3830,Y,0,ER4\n";
+    REQUIRE_THROWS_AS(FlightGraph("test-routes.dat", "airports-test.dat"), std::invalid_argument);
+    REQUIRE_THROWS_AS(FlightGraph("test-routes.dat", "airports-test.dat", 4), std::invalid_argument);
+    std::remove("test-routes.dat");
+}
+
+TEST_CASE("ThreadPool") {
+    ThreadPool pool(4);
+    REQUIRE(pool.getThreadCount() == 4);
+    REQUIRE(ThreadPool(0).getThreadCount() == 1);
+
+    //Every task runs exactly once on a valid worker, and the pool can be reused
+    for (size_t taskCount : {0, 1, 3, 1000}) {
+        std::vector<int> runCounts(taskCount, 0);
+        std::vector<size_t> workers(taskCount, 0);
+        pool.run(taskCount, [&](size_t task, size_t worker) {
+            ++runCounts.at(task);
+            workers.at(task) = worker;
+        });
+        REQUIRE(std::count(runCounts.begin(), runCounts.end(), 1) == (long) taskCount);
+        REQUIRE(std::all_of(workers.begin(), workers.end(), [](size_t worker) { return worker < 4; }));
+    }
+
+    //Exceptions reach the caller after the whole batch has run
+    std::atomic<size_t> finishedCount(0);
+    REQUIRE_THROWS_AS(pool.run(100, [&](size_t task, size_t) {
+        if (task == 42) {
+            throw std::runtime_error("task failed");
+        }
+        ++finishedCount;
+    }), std::runtime_error);
+    REQUIRE(finishedCount == 99);
+}
+
+TEST_CASE("Vertex ID API") {
+    FlightGraph graph("routes-test-directed.dat", "airports-test.dat");
+
+    REQUIRE(graph.getVertexCount() == 9);
+    for (const std::string& code : graph.airportCodeList) { //IDs and codes round trip
+        REQUIRE(graph.getAirportCode(graph.getVertexId(code)) == code);
+        REQUIRE(graph.getVertexId(code) == (FlightGraph::VertexId) graph.airportCodeMap.at(code));
+    }
+    REQUIRE_THROWS_AS(graph.getVertexId("XXX"), std::out_of_range);
+
+    FlightGraph::VertexId CMI = graph.getVertexId("CMI");
+    FlightGraph::VertexId DFW = graph.getVertexId("DFW");
+    FlightGraph::VertexId ORD = graph.getVertexId("ORD");
+    FlightGraph::VertexId MSP = graph.getVertexId("MSP");
+
+    //neighbors
+    const FlightGraph::NeighborRange& incident = graph.neighbors(DFW);
+    REQUIRE(std::vector<FlightGraph::VertexId>(incident.begin(), incident.end()) == std::vector<FlightGraph::VertexId> {CMI, graph.getVertexId("IAD"), graph.getVertexId("IAH"), ORD});
+    REQUIRE(incident.weights[0] == Approx(1114).epsilon(0.01));
+    REQUIRE(graph.neighbors(CMI).size() == 1);
+
+    //areAdjacent
+    REQUIRE(graph.areAdjacent(CMI, ORD));
+    REQUIRE_FALSE(graph.areAdjacent(ORD, CMI));
+    REQUIRE_FALSE(graph.areAdjacent(CMI, CMI));
+
+    //Traversals agree with the string-keyed methods
+    for (const std::string& origin : graph.airportCodeList) {
+        const std::vector<std::vector<FlightGraph::VertexId>>& bfs = graph.breadthFirstSearch(graph.getVertexId(origin));
+        const std::vector<std::vector<std::string>>& bfsCodes = graph.breadthFirstSearch(origin);
+        REQUIRE(bfs.size() == bfsCodes.size());
+        for (size_t componentIndex = 0; componentIndex < bfs.size(); ++componentIndex) {
+            REQUIRE(bfs.at(componentIndex).size() == bfsCodes.at(componentIndex).size());
+            for (size_t i = 0; i < bfs.at(componentIndex).size(); ++i) {
+                REQUIRE(graph.getAirportCode(bfs.at(componentIndex).at(i)) == bfsCodes.at(componentIndex).at(i));
+            }
+        }
+    }
+    REQUIRE(graph.findShortestPath(CMI, DFW) == std::vector<FlightGraph::VertexId> {CMI, ORD, graph.getVertexId("RDU"), graph.getVertexId("IAD"), DFW});
+    REQUIRE(graph.findShortestPath(MSP, MSP) == std::vector<FlightGraph::VertexId> {MSP});
+    REQUIRE(graph.findShortestLandmarkPath(std::vector<FlightGraph::VertexId> {CMI, CMI, ORD}) == std::vector<FlightGraph::VertexId> {CMI, ORD});
+}
+
+TEST_CASE("DaryHeap") {
+    DaryHeap<int> heap;
+    REQUIRE(heap.empty());
+
+    std::vector<double> keys {5.0, 1.0, 9.0, 3.0, 7.0, 1.0, 8.0, 2.0, 6.0, 4.0, 0.5};
+    for (size_t i = 0; i < keys.size(); ++i) {
+        heap.push(keys.at(i), (int) i);
+    }
+    REQUIRE(heap.size() == keys.size());
+
+    std::vector<std::pair<double, int>> popped;
+    while (!heap.empty()) {
+        popped.push_back(heap.top());
+        heap.pop();
+    }
+    REQUIRE(popped == std::vector<std::pair<double, int>> {{0.5, 10}, {1.0, 1}, {1.0, 5}, {2.0, 7}, {3.0, 3}, {4.0, 9}, {5.0, 0}, {6.0, 8}, {7.0, 4}, {8.0, 6}, {9.0, 2}}); //Equal keys are ordered by value
+}
+
+TEST_CASE("SearchContext") {
+    FlightGraph graph("routes-test-undirected.dat", "airports-test.dat");
+    SearchContext context;
+    std::vector<FlightGraph::VertexId> path;
+    double relativeErrorTolerance = 0.01;
+
+    //The same context gives the same results as fresh searches, and labels from earlier searches are not visible to later ones
+    for (const std::string& origin : graph.airportCodeList) {
+        for (const std::string& destination : graph.airportCodeList) {
+            graph.findShortestPath(graph.getVertexId(origin), graph.getVertexId(destination), context, path);
+            REQUIRE(path == graph.findShortestPath(graph.getVertexId(origin), graph.getVertexId(destination)));
+            REQUIRE(context.getDistance(graph.getVertexId(origin)) == 0);
+            REQUIRE(context.getPredecessor(graph.getVertexId(origin)) == FlightGraph::invalidVertexId);
+            REQUIRE(context.isSettled(graph.getVertexId(destination)));
+        }
+    }
+
+    graph.findShortestPath(graph.getVertexId("CMI"), graph.getVertexId("MSP"), context, path); //CMI -> ORD -> RDU -> STL -> MSP
+    REQUIRE(context.getDistance(graph.getVertexId("MSP")) == Approx(218 + 1039 + 1071 + 721).epsilon(relativeErrorTolerance));
+    REQUIRE(context.getPredecessor(graph.getVertexId("MSP")) == graph.getVertexId("STL"));
+
+    graph.findShortestPath(graph.getVertexId("CMI"), graph.getVertexId("ORD"), context, path); //The early exit leaves distant airports unreached
+    REQUIRE(context.getDistance(graph.getVertexId("CMI")) == 0);
+    REQUIRE(context.getDistance(graph.getVertexId("ORD")) == Approx(218).epsilon(relativeErrorTolerance));
+    REQUIRE_FALSE(context.isReached(graph.getVertexId("MSP")));
+    REQUIRE(context.getDistance(graph.getVertexId("MSP")) == std::numeric_limits<double>::max());
+    REQUIRE(context.getSettledCount() == 2);
+}
+
 /*
 Coordinates come from airports-extended.dat
 Note that the Earth is not a perfect sphere so the tests use a relative error tolerance